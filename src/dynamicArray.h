@@ -21,6 +21,42 @@ struct ArrayChunk
         ArrayChunk* tailChunk;
     };
 
+template <typename T>
+struct DynamicArrayIterator
+{
+    ArrayChunk** chunk;
+    T* element;
+    T* chunkEnd;
+    uint32 index;
+    uint32 count;
+    uint32 elementsPerChunk;
+
+    inline T& operator*() const { return *element; }
+    inline T* operator->() const { return element; }
+
+    inline bool operator!=(const DynamicArrayIterator& other) const
+    {
+        return index != other.index;
+    }
+
+    // Only steps into the chunk directory when crossing a chunk boundary,
+    // so a range loop touches each chunk once.
+    inline DynamicArrayIterator& operator++()
+    {
+        index++;
+        element++;
+
+        if (element == chunkEnd && index < count)
+        {
+            chunk++;
+            element = (T*)(*chunk)->data;
+            chunkEnd = element + elementsPerChunk;
+        }
+
+        return *this;
+    }
+};
+
 template <typename T>
 struct DynamicArray
 {
@@ -31,33 +67,77 @@ struct DynamicArray
     ArrayChunk* headChunk;
     ArrayChunk* tailChunk;
 
+    // Chunk directory: elementsPerChunk is always a power of two so an index
+    // splits into (index >> chunkShift, index & chunkMask) without walking the list.
+    uint32 chunkShift;
+    uint32 chunkMask;
+    uint32 chunkDirectoryCapacity;
+    ArrayChunk** chunkDirectory;
+
+    MemoryTag tag;
+
     inline T& operator[](const int index) const
     {
         // Bounds check
         assert(index >= 0 && index < count);
 
-        // Find the chunk
-        s32 chunkIndex = index / elementsPerChunk;
-        ArrayChunk* chunk = headChunk;
+        ArrayChunk* chunk = chunkDirectory[(uint32)index >> chunkShift];
 
-        for (int32 i = 0; i < chunkIndex && chunk != nullptr; i++)
-        {
-            chunk = chunk->nextChunk;
-        }
+        // Return reference to the element
+        return ((T*)chunk->data)[(uint32)index & chunkMask];
+    }
 
-        assert(chunk != nullptr);
+    inline DynamicArrayIterator<T> begin() const
+    {
+        DynamicArrayIterator<T> it = {};
+        it.chunk = chunkDirectory;
+        it.count = count;
+        it.elementsPerChunk = elementsPerChunk;
 
-        // Calculate offset within chunk
-        size_t elementOffset = index % elementsPerChunk;
+        if (count > 0)
+        {
+            it.element = (T*)chunkDirectory[0]->data;
+            it.chunkEnd = it.element + elementsPerChunk;
+        }
 
-        // Get pointer to data area (immediately after chunk header)
-        uint8* dataStart = (uint8*)chunk + sizeof(ArrayChunk);
+        return it;
+    }
 
-        // Return reference to the element
-        return ((T*)dataStart)[elementOffset];
+    inline DynamicArrayIterator<T> end() const
+    {
+        DynamicArrayIterator<T> it = {};
+        it.index = count;
+        return it;
     }
 };
 
+    inline uint32 DynamicArrayRoundUpPow2(uint32 value)
+    {
+        uint32 result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    template <typename T>
+    void DynamicArrayGrowDirectory(DynamicArray<T>* array)
+    {
+        uint32 newCapacity = array->chunkDirectoryCapacity ? array->chunkDirectoryCapacity * 2 : 8;
+        ArrayChunk** newDirectory = (ArrayChunk**)AllocateMem(array->allocator, sizeof(ArrayChunk*) * newCapacity);
+        TrackAllocation(array->tag, sizeof(ArrayChunk*) * newCapacity);
+
+        if (array->chunkDirectory)
+        {
+            memcpy(newDirectory, array->chunkDirectory, sizeof(ArrayChunk*) * array->chunkCount);
+            DeallocateMem(array->allocator, array->chunkDirectory);
+            TrackFree(array->tag, sizeof(ArrayChunk*) * array->chunkDirectoryCapacity);
+        }
+
+        array->chunkDirectory = newDirectory;
+        array->chunkDirectoryCapacity = newCapacity;
+    }
 
     template <typename T>
     void DynamicArrayAllocateChunk(DynamicArray<T>* array)
@@ -68,6 +148,7 @@ struct DynamicArray
 
         // Allocate the entire block
         uint8* memory = (uint8*)AllocateMem(array->allocator, totalSize);
+        TrackAllocation(array->tag, totalSize);
 
         // Set up the chunk header
         ArrayChunk* newChunk = (ArrayChunk*)memory;
@@ -85,6 +166,12 @@ struct DynamicArray
             array->tailChunk = newChunk;
         }
 
+        if (array->chunkCount == array->chunkDirectoryCapacity)
+        {
+            DynamicArrayGrowDirectory(array);
+        }
+
+        array->chunkDirectory[array->chunkCount] = newChunk;
         array->chunkCount++;
     }
 
@@ -107,9 +194,10 @@ struct DynamicArray
 
         if (array->chunkCount * array->elementsPerChunk < capacity)
         {
-            uint32 chunksToAdd = ((capacity / array->elementsPerChunk) - array->chunkCount) + 1;
+            uint32 chunksNeeded = (capacity + array->chunkMask) >> array->chunkShift;
+            uint32 chunksToAdd = chunksNeeded - array->chunkCount;
 
-            for (int i = 0; i < chunksToAdd; i++)
+            for (uint32 i = 0; i < chunksToAdd; i++)
             {
                 DynamicArrayAllocateChunk(array);
             }
@@ -120,11 +208,17 @@ struct DynamicArray
     void DynamicArrayEnsureCapacity(DynamicArray_Untyped* array, uint32 elementSize, uint32 capacity);
 
     template <typename T>
-    inline DynamicArray<T> MakeDynamicArray(MAllocator* allocator, uint32 elementsPerChunk, uint32 chunkCount = 1)
+    inline DynamicArray<T> MakeDynamicArray(MAllocator* allocator, uint32 elementsPerChunk, uint32 chunkCount = 1, MemoryTag tag = MemoryTag_Untagged)
     {
         DynamicArray<T> array = {};
         array.allocator = allocator;
-        array.elementsPerChunk = elementsPerChunk;
+        array.tag = tag;
+        array.elementsPerChunk = DynamicArrayRoundUpPow2(elementsPerChunk);
+        array.chunkMask = array.elementsPerChunk - 1;
+        while ((1u << array.chunkShift) < array.elementsPerChunk)
+        {
+            array.chunkShift++;
+        }
 
         DynamicArrayEnsureCapacity(&array, chunkCount * elementsPerChunk);
 
@@ -133,17 +227,27 @@ struct DynamicArray
 
     template <typename T>
     inline void DeallocateDynamicArray(DynamicArray<T>* array) {
+        uint64 chunkSize = sizeof(ArrayChunk) + array->elementsPerChunk * sizeof(T);
+
         ArrayChunk* chunk = array->headChunk;
-        ArrayChunk* nextChunk = chunk->nextChunk;
         while (chunk != NULL) {
+            ArrayChunk* nextChunk = chunk->nextChunk;
             DeallocateMem(array->allocator, chunk);
-
+            TrackFree(array->tag, chunkSize);
             chunk = nextChunk;
+        }
 
-            if (chunk) {
-                nextChunk = nextChunk->nextChunk;
-            }
+        if (array->chunkDirectory) {
+            DeallocateMem(array->allocator, array->chunkDirectory);
+            TrackFree(array->tag, sizeof(ArrayChunk*) * array->chunkDirectoryCapacity);
         }
+
+        array->headChunk = NULL;
+        array->tailChunk = NULL;
+        array->chunkDirectory = NULL;
+        array->chunkDirectoryCapacity = 0;
+        array->chunkCount = 0;
+        array->count = 0;
     }
 
     template <typename T>
@@ -156,6 +260,73 @@ struct DynamicArray
         return index;
     }
 
+    // Appends elementCount elements with one capacity check and one memcpy per chunk.
+    // Returns the index of the first appended element.
+    template <typename T>
+    inline uint32 PushBackN(DynamicArray<T>* array, const T* elems, uint32 elementCount)
+    {
+        DynamicArrayEnsureCapacity(array, array->count + elementCount);
+        uint32 firstIndex = array->count;
+        array->count += elementCount;
+
+        const T* cursor = elems;
+        DynamicArrayForEachChunk(array, firstIndex, elementCount, [&cursor](T* data, uint32 spanCount) {
+            memcpy(data, cursor, sizeof(T) * spanCount);
+            cursor += spanCount;
+        });
+
+        return firstIndex;
+    }
+
+    // Calls func(T* data, uint32 count) once per chunk for elements
+    // [firstIndex, firstIndex + elementCount), so callers can memcpy whole spans.
+    template <typename T, typename F>
+    inline void DynamicArrayForEachChunk(DynamicArray<T>* array, uint32 firstIndex, uint32 elementCount, F&& func)
+    {
+        assert(firstIndex + elementCount <= array->count);
+
+        uint32 index = firstIndex;
+        uint32 remaining = elementCount;
+        while (remaining > 0)
+        {
+            uint32 offsetInChunk = index & array->chunkMask;
+            uint32 spanCount = array->elementsPerChunk - offsetInChunk;
+            if (spanCount > remaining)
+            {
+                spanCount = remaining;
+            }
+
+            T* data = (T*)array->chunkDirectory[index >> array->chunkShift]->data + offsetInChunk;
+            func(data, spanCount);
+
+            index += spanCount;
+            remaining -= spanCount;
+        }
+    }
+
+    template <typename T, typename F>
+    inline void DynamicArrayForEachChunk(DynamicArray<T>* array, F&& func)
+    {
+        DynamicArrayForEachChunk(array, 0, array->count, func);
+    }
+
+    // Copies elements [firstIndex, firstIndex + elementCount) into dest with one memcpy per chunk.
+    template <typename T>
+    inline void DynamicArrayCopyToContiguous(DynamicArray<T>* array, T* dest, uint32 firstIndex, uint32 elementCount)
+    {
+        T* cursor = dest;
+        DynamicArrayForEachChunk(array, firstIndex, elementCount, [&cursor](T* data, uint32 spanCount) {
+            memcpy(cursor, data, sizeof(T) * spanCount);
+            cursor += spanCount;
+        });
+    }
+
+    template <typename T>
+    inline void DynamicArrayCopyToContiguous(DynamicArray<T>* array, T* dest)
+    {
+        DynamicArrayCopyToContiguous(array, dest, 0, array->count);
+    }
+
 ////template <typename T>
 ////inline T* PushBackPtr(DynamicArray<T>* array) {
 ////    DynamicArrayEnsureCapacity(array, array->count + 1);
@@ -3,14 +3,8 @@
 //
 
 
+// Transform, mesh and material live in the EntityTypeBuffer columns.
 struct WallEntity: Entity {
-    vec3 position = V3(0, 0, 0);
-    vec3 rotation = V3(0, 0, 0);
-    vec3 scale = V3(1, 1, 1);
-
-    // Render data (walls always render)
-    Mesh* mesh;
-    Material* material;
 };
 
 
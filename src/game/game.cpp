@@ -7,8 +7,8 @@
 #include "entities/LightSourceEntity.cpp"
 
 void InitEntityHandleBuffers(GameData* gameData, MemoryArena* arena) {
-    gameData->walls = MakeDynamicArray<EntityHandle>(arena, 10);
-    gameData->lightSources = MakeDynamicArray<EntityHandle>(arena, 10);
+    gameData->walls = MakeDynamicArray<EntityHandle>(arena, 10, 1, MemoryTag_Level);
+    gameData->lightSources = MakeDynamicArray<EntityHandle>(arena, 10, 1, MemoryTag_Level);
 
 }
 
@@ -17,6 +17,7 @@ void InitGame(Zayn *zaynMem) {
     MeshCreationInfo m1 = {};
     m1.name = "viking_room";
     m1.path = GetModelPath("viking_room.obj");
+    m1.vertexFormat = VertexFormat_Compact;
     Mesh* mesh1 = MakeMesh(zaynMem, &m1);
 
     //Test Procedural Wall
@@ -82,8 +83,8 @@ void InitGame(Zayn *zaynMem) {
     // WallEntity* wallEntity = (WallEntity*)GetEntity(&zaynMem->entityFactory, wall_1);
     // wallEntity->material = mat1;
     // wallEntity->mesh = mesh1;
-    // // AddComponents(&zaynMem->componentsFactory.componentsStorage.materialComponents, wall_1);
-    // MaterialComponents* matComp = FindComponentsInArray(&zaynMem->componentsFactory.componentsStorage.materialComponents, wall_1);
+    // // AddComponent<MaterialComponents>(&zaynMem->componentsFactory.registry, wall_1);
+    // MaterialComponents* matComp = GetComponent<MaterialComponents>(&zaynMem->componentsFactory.registry, wall_1);
 
     // EntityHandle newEntityHandle = {};
     // AddEntity(&zaynMem->entityFactory, &newEntityHandle, entityCreator.selectedEntityType);
@@ -2,13 +2,21 @@
 // Created by Adam Socki on 6/2/25.
 //
 
-enum ComponentsType {
-    TransformComponents_Type,
-    MeshComponents_Type,
-    MaterialComponents_Type,
+// Each component type gets a small dense id the first time it is used, so
+// the registry can index its column stores without a hand-maintained enum.
+#define MAX_COMPONENT_TYPES 64
 
-    ComponentsType_Count,
-};
+inline uint32 NextComponentTypeId() {
+    static uint32 nextId = 0;
+    assert(nextId < MAX_COMPONENT_TYPES);
+    return nextId++;
+}
+
+template<typename T>
+inline uint32 ComponentTypeId() {
+    static const uint32 id = NextComponentTypeId();
+    return id;
+}
 
 struct Components {
     EntityHandle owner;
@@ -6,31 +6,26 @@ struct Mesh {
 
     std::string name;
     std::string path;
+    // Where the mesh lives in the renderer's GeometryPool; the buffers are the
+    // pool's, shared with every other mesh of the same vertex format.
     VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
     VkBuffer indexBuffer;
-    VkDeviceMemory indexBufferMemory;
+    int32_t vertexOffset;
+    uint32_t firstIndex;
     uint32_t indexCount;
     uint32_t vertexCount;
 
+    // Only the array matching vertexFormat is filled; the vertex buffer holds the same data.
+    VertexFormat vertexFormat;
     std::vector<Vertex> vertices;
+    std::vector<VertexCompact> compactVertices;
     std::vector<uint32_t> indices;
 
-    bool isInitialized = false;
-
-
-    // Instancing support
-    bool supportsInstancing = false;
-    VkBuffer instanceBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory instanceBufferMemory = VK_NULL_HANDLE;
-    void* instanceBufferMapped = nullptr;
-    uint32_t instanceCount = 0;
-    uint32_t maxInstances = 0;
-
-    DynamicArray<InstancedData> instanceData;
-    DynamicArray<EntityHandle> registeredEntities;
-    bool instanceDataRequiresGpuUpdate = true;
+    // Local-space bounds, used for frustum culling
+    vec3 boundsMin;
+    vec3 boundsMax;
 
+    bool isInitialized = false;
 };
 
 
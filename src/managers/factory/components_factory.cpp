@@ -8,10 +8,14 @@
 #include "components/material_components.cpp"
 
 
-void InitComponentsFactory(ComponentsFactory* factory, MemoryArena* arena) {
-    factory->componentsStorage.transformComponents =        MakeDynamicArray<TransformComponents>(arena, 1280);
-    factory->componentsStorage.meshComponents =             MakeDynamicArray<MeshComponents>(arena, 1280);
-    factory->componentsStorage.materialComponents =         MakeDynamicArray<MaterialComponents>(arena, 1280);
+void InitComponentsFactory(ComponentsFactory* factory, MAllocator* allocator) {
+    factory->registry = {};
+    factory->registry.allocator = allocator;
+    factory->registry.defaultCapacity = 1280;
+
+    GetComponentStore<TransformComponents>(&factory->registry);
+    GetComponentStore<MeshComponents>(&factory->registry);
+    GetComponentStore<MaterialComponents>(&factory->registry);
 
 }
 
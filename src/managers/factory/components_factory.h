@@ -2,6 +2,8 @@
 // Created by Adam Socki on 6/1/25.
 //
 
+#include <tuple>
+
 #include "components/components.h"
 
 #include "components/transform_components.h"
@@ -9,49 +11,236 @@
 #include "components/material_components.h"
 
 
+inline bool AreHandlesEqual(EntityHandle h1, EntityHandle h2) {
+    return h1.indexInInfo == h2.indexInInfo &&
+           h1.generation == h2.generation &&
+           h1.type == h2.type;
+}
+
+#define COMPONENT_INDEX_INVALID 0xFFFFFFFF
+
+// Sparse set keyed by EntityHandle::indexInInfo. sparse[indexInInfo] is the
+// slot in the packed dense array (or COMPONENT_INDEX_INVALID), so add, find
+// and remove are O(1) and iterating dense touches only live components.
+// Removing swaps the last component into the hole, and growing dense may move
+// it, so don't hold component pointers across adds or removes.
+template<typename T>
+struct ComponentStore {
+    MArray<uint32> sparse;
+    MArray<T> dense;
+};
+
 template<typename T>
-    inline T* AddComponents(DynamicArray<T>* componentArray, EntityHandle entityHandle) {
-    if (!componentArray) {
-        printf("Error: Component array pointer is null.\n");
+inline ComponentStore<T> MakeComponentStore(MAllocator* allocator, uint32 capacity) {
+    ComponentStore<T> store = {};
+    store.sparse = MakeMArray<uint32>(allocator, capacity, MemoryTag_Entity);
+    store.dense = MakeMArray<T>(allocator, capacity, MemoryTag_Entity);
+    return store;
+}
+
+template<typename T>
+inline uint32 GetComponentIndex(ComponentStore<T>* store, EntityHandle entityHandle) {
+    if (entityHandle.indexInInfo < 0 || (uint32)entityHandle.indexInInfo >= store->sparse.count) {
+        return COMPONENT_INDEX_INVALID;
+    }
+
+    uint32 denseIndex = store->sparse[entityHandle.indexInInfo];
+    if (denseIndex == COMPONENT_INDEX_INVALID || !AreHandlesEqual(store->dense[denseIndex].owner, entityHandle)) {
+        return COMPONENT_INDEX_INVALID;
+    }
+
+    return denseIndex;
+}
+
+template<typename T>
+    inline T* FindComponents(ComponentStore<T>* store, EntityHandle entityHandle) {
+    if (!store) {
         return nullptr;
     }
 
+    uint32 denseIndex = GetComponentIndex(store, entityHandle);
+    if (denseIndex == COMPONENT_INDEX_INVALID) {
+        return nullptr;
+    }
+
+    return &store->dense[denseIndex];
+}
+
+template<typename T>
+    inline bool RemoveComponents(ComponentStore<T>* store, EntityHandle entityHandle) {
+    uint32 denseIndex = GetComponentIndex(store, entityHandle);
+    if (denseIndex == COMPONENT_INDEX_INVALID) {
+        return false;
+    }
+
+    uint32 lastIndex = store->dense.count - 1;
+    if (denseIndex != lastIndex) {
+        store->sparse[store->dense[lastIndex].owner.indexInInfo] = denseIndex;
+    }
+
+    RemoveAtIndexBySwap(&store->dense, denseIndex);
+    store->sparse[entityHandle.indexInInfo] = COMPONENT_INDEX_INVALID;
+    return true;
+}
+
+// Returns the existing components if the entity already has them.
+template<typename T>
+    inline T* AddComponents(ComponentStore<T>* store, EntityHandle entityHandle) {
+    if (!store) {
+        printf("Error: Component store pointer is null.\n");
+        return nullptr;
+    }
+    assert(entityHandle.indexInInfo >= 0);
+
+    uint32 sparseIndex = (uint32)entityHandle.indexInInfo;
+    if (sparseIndex >= store->sparse.count) {
+        uint32 oldCount = store->sparse.count;
+        uint32 newCount = sparseIndex + 1;
+        if (newCount < store->sparse.capacity) {
+            newCount = store->sparse.capacity;
+        }
+
+        Resize(&store->sparse, newCount);
+        memset(store->sparse.data + oldCount, 0xFF, sizeof(uint32) * (newCount - oldCount));
+    }
+
+    uint32 denseIndex = store->sparse[sparseIndex];
+    if (denseIndex != COMPONENT_INDEX_INVALID) {
+        T* existing = &store->dense[denseIndex];
+        if (AreHandlesEqual(existing->owner, entityHandle)) {
+            return existing;
+        }
+
+        // Left over from an older generation of this slot.
+        RemoveComponents(store, existing->owner);
+    }
+
     T newComp = {};
     newComp.owner = entityHandle;
-    uint32 index = PushBack(componentArray, newComp);
+    denseIndex = PushBack(&store->dense, newComp);
+    store->sparse[sparseIndex] = denseIndex;
 
+    return &store->dense[denseIndex];
+}
+
+// Type-erased handle to one ComponentStore<T>, so the registry can count,
+// walk and remove components without knowing T.
+struct ComponentPool {
+    void* store;
+
+    uint32 (*count)(void* store);
+    EntityHandle (*ownerAt)(void* store, uint32 index);
+    bool (*remove)(void* store, EntityHandle entityHandle);
+};
 
-    return &(*componentArray)[index];
+template<typename T>
+uint32 ComponentStoreCount(void* store) {
+    return ((ComponentStore<T>*)store)->dense.count;
 }
-inline bool AreHandlesEqual(EntityHandle h1, EntityHandle h2) {
-    return h1.indexInInfo == h2.indexInInfo &&
-           h1.generation == h2.generation &&
-           h1.type == h2.type;
+
+template<typename T>
+EntityHandle ComponentStoreOwnerAt(void* store, uint32 index) {
+    return ((ComponentStore<T>*)store)->dense[index].owner;
 }
 
 template<typename T>
-    inline T* FindComponentsInArray(DynamicArray<T>* componentArray, EntityHandle entityHandle) {
-    if (!componentArray) {
-        return nullptr;
+bool ComponentStoreRemove(void* store, EntityHandle entityHandle) {
+    return RemoveComponents((ComponentStore<T>*)store, entityHandle);
+}
+
+struct ComponentRegistry {
+    MAllocator* allocator;
+    uint32 defaultCapacity;
+
+    ComponentPool pools[MAX_COMPONENT_TYPES];
+};
+
+// Creates the column store for T the first time it is asked for.
+template<typename T>
+ComponentStore<T>* GetComponentStore(ComponentRegistry* registry) {
+    ComponentPool* pool = &registry->pools[ComponentTypeId<T>()];
+
+    if (!pool->store) {
+        ComponentStore<T>* store = (ComponentStore<T>*)AllocateMem(registry->allocator, sizeof(ComponentStore<T>));
+        *store = MakeComponentStore<T>(registry->allocator, registry->defaultCapacity);
+
+        pool->store = store;
+        pool->count = &ComponentStoreCount<T>;
+        pool->ownerAt = &ComponentStoreOwnerAt<T>;
+        pool->remove = &ComponentStoreRemove<T>;
     }
-    for (uint32 i = 0; i < componentArray->count; ++i) {
-        // Compare the owner handle of the component in the array with the target handle
-        if (AreHandlesEqual((*componentArray)[i].owner, entityHandle)) {
-            // Found it, return pointer to the data in the array
-            return &(*componentArray)[i];
+
+    return (ComponentStore<T>*)pool->store;
+}
+
+template<typename T>
+inline T* AddComponent(ComponentRegistry* registry, EntityHandle entityHandle) {
+    return AddComponents(GetComponentStore<T>(registry), entityHandle);
+}
+
+template<typename T>
+inline T* GetComponent(ComponentRegistry* registry, EntityHandle entityHandle) {
+    return FindComponents(GetComponentStore<T>(registry), entityHandle);
+}
+
+template<typename T>
+inline bool RemoveComponent(ComponentRegistry* registry, EntityHandle entityHandle) {
+    return RemoveComponents(GetComponentStore<T>(registry), entityHandle);
+}
+
+inline void RemoveAllComponents(ComponentRegistry* registry, EntityHandle entityHandle) {
+    for (uint32 i = 0; i < MAX_COMPONENT_TYPES; i++) {
+        ComponentPool* pool = &registry->pools[i];
+        if (pool->store) {
+            pool->remove(pool->store, entityHandle);
         }
     }
-    return nullptr; // Not found
 }
 
-struct ComponentsStorage {
-    DynamicArray<TransformComponents>   transformComponents;
-    DynamicArray<MeshComponents>        meshComponents;
-    DynamicArray<MaterialComponents>    materialComponents;
+// Query over every entity that has all of Ts. ForEach walks the owners of
+// the smallest store and probes the rest, so the cost follows the rarest
+// component. Don't add or remove Ts components from inside func.
+template<typename... Ts>
+struct View {
+    ComponentRegistry* registry;
+    std::tuple<ComponentStore<Ts>*...> stores;
 };
 
+template<typename... Ts>
+inline View<Ts...> MakeView(ComponentRegistry* registry) {
+    View<Ts...> view = {};
+    view.registry = registry;
+    view.stores = std::make_tuple(GetComponentStore<Ts>(registry)...);
+    return view;
+}
+
+// func(EntityHandle, Ts*...)
+template<typename... Ts, typename F>
+void ForEach(View<Ts...>* view, F&& func) {
+    ComponentPool* candidates[] = { &view->registry->pools[ComponentTypeId<Ts>()]... };
+
+    ComponentPool* smallest = candidates[0];
+    for (uint32 i = 1; i < sizeof...(Ts); i++) {
+        if (candidates[i]->count(candidates[i]->store) < smallest->count(smallest->store)) {
+            smallest = candidates[i];
+        }
+    }
+
+    uint32 count = smallest->count(smallest->store);
+    for (uint32 i = 0; i < count; i++) {
+        EntityHandle owner = smallest->ownerAt(smallest->store, i);
+
+        std::tuple<Ts*...> components = std::make_tuple(FindComponents(std::get<ComponentStore<Ts>*>(view->stores), owner)...);
+
+        bool hasAll = std::apply([](auto*... ptrs) { return ((ptrs != nullptr) && ...); }, components);
+        if (hasAll) {
+            std::apply([&](auto*... ptrs) { func(owner, ptrs...); }, components);
+        }
+    }
+}
+
 struct ComponentsFactory {
-    ComponentsStorage componentsStorage;
+    ComponentRegistry registry;
 };
 
 
@@ -1,10 +1,10 @@
 
 void InitEntityTypeInfo( Zayn* zaynMem) {
 	constexpr EntityTypeInfoForBuffer defaultEntityTypeInfo[] = {
-		[EntityType_Player] = {EntityType_Player, sizeof(int32), 10, "Player"},
-		[EntityType_Floor]  = {EntityType_Floor, sizeof(int32), 10000, "Floor"},
-		[EntityType_Piano]  = {EntityType_Piano, sizeof(int32), 10, "Grand Piano"},
-		[EntityType_Wall]  = {EntityType_Wall, sizeof(WallEntity), 100, "Wall"},
+		[EntityType_Player] = {EntityType_Player, sizeof(Entity), 10, "Player"},
+		[EntityType_Floor]  = {EntityType_Floor, sizeof(Entity), 10000, "Floor"},
+		[EntityType_Piano]  = {EntityType_Piano, sizeof(Entity), 10, "Grand Piano"},
+		[EntityType_Wall]  = {EntityType_Wall, sizeof(WallEntity), 100, "Wall", true},
 		[EntityType_LightSource]  = {EntityType_LightSource, sizeof(LightSourceEntity), 50, "Light Source"},
 		// Add maor here...
 	};
@@ -12,35 +12,104 @@ void InitEntityTypeInfo( Zayn* zaynMem) {
 	memcpy(zaynMem->entityFactory.entityTypeInfoForBuffer, defaultEntityTypeInfo, sizeof(defaultEntityTypeInfo));
 }
 
+#define ENTITY_INFO_INITIAL_CAPACITY 1024
+
+// Moves a column into a new aligned block of newCapacity elements; the tail is zeroed.
+inline void* ReallocateEntityColumn(void* column, uint64 elementSize, int32 count, int32 oldCapacity, int32 newCapacity) {
+	uint64 newSize = elementSize * newCapacity;
+	void* newColumn = MArrayAllocateAligned(NULL, newSize);
+	memset(newColumn, 0, newSize);
+	TrackAllocation(MemoryTag_Entity, newSize);
+
+	if (column) {
+		memcpy(newColumn, column, elementSize * count);
+		MArrayFreeAligned(NULL, column);
+		TrackFree(MemoryTag_Entity, elementSize * oldCapacity);
+	}
+
+	return newColumn;
+}
+
+void GrowEntityTypeBuffer(EntityTypeBuffer* buffer, int32 newCapacity) {
+	if (newCapacity <= buffer->capacity) {
+		return;
+	}
+
+	int32 oldCapacity = buffer->capacity;
+	int32 count = buffer->count;
+
+	buffer->entities = ReallocateEntityColumn(buffer->entities, buffer->sizeInBytes, count, oldCapacity, newCapacity);
+	buffer->positions = (vec3*)ReallocateEntityColumn(buffer->positions, sizeof(vec3), count, oldCapacity, newCapacity);
+	buffer->rotations = (vec3*)ReallocateEntityColumn(buffer->rotations, sizeof(vec3), count, oldCapacity, newCapacity);
+	buffer->scales = (vec3*)ReallocateEntityColumn(buffer->scales, sizeof(vec3), count, oldCapacity, newCapacity);
+	buffer->meshes = (Mesh**)ReallocateEntityColumn(buffer->meshes, sizeof(Mesh*), count, oldCapacity, newCapacity);
+	buffer->materials = (Material**)ReallocateEntityColumn(buffer->materials, sizeof(Material*), count, oldCapacity, newCapacity);
+	buffer->isStatic = (bool*)ReallocateEntityColumn(buffer->isStatic, sizeof(bool), count, oldCapacity, newCapacity);
+	buffer->handles = (EntityHandle*)ReallocateEntityColumn(buffer->handles, sizeof(EntityHandle), count, oldCapacity, newCapacity);
+	buffer->parents = (EntityHandle*)ReallocateEntityColumn(buffer->parents, sizeof(EntityHandle), count, oldCapacity, newCapacity);
+	buffer->localMatrices = (mat4*)ReallocateEntityColumn(buffer->localMatrices, sizeof(mat4), count, oldCapacity, newCapacity);
+	buffer->worldMatrices = (mat4*)ReallocateEntityColumn(buffer->worldMatrices, sizeof(mat4), count, oldCapacity, newCapacity);
+	buffer->transformFlags = (u8*)ReallocateEntityColumn(buffer->transformFlags, sizeof(u8), count, oldCapacity, newCapacity);
+	buffer->depths = (u8*)ReallocateEntityColumn(buffer->depths, sizeof(u8), count, oldCapacity, newCapacity);
+	buffer->levelIndices = (int32*)ReallocateEntityColumn(buffer->levelIndices, sizeof(int32), count, oldCapacity, newCapacity);
+
+	buffer->capacity = newCapacity;
+}
+
+void GrowEntityInfos(EntityFactory* entityFactory, int32 newCapacity) {
+	if (newCapacity <= entityFactory->entityCapacity) {
+		return;
+	}
+
+	entityFactory->entities = (EntityInfo*)ReallocateEntityColumn(entityFactory->entities, sizeof(EntityInfo),
+	                                                              entityFactory->nextID, entityFactory->entityCapacity, newCapacity);
+	entityFactory->entityCapacity = newCapacity;
+}
+
 void InitEntityBuffers(EntityFactory* entityFactory) {
 	for (int i = 0; i < EntityType_Count; i++)
 	{
 		EntityTypeInfoForBuffer info = entityFactory->entityTypeInfoForBuffer[i];
 		EntityTypeBuffer* buffer = &entityFactory->buffers[i];
-		buffer->capacity = info.defaultCapacity;
+		*buffer = {};
 		buffer->sizeInBytes = info.structSize;
-		buffer->count = 0;
-		buffer->entities = malloc(buffer->capacity * buffer->sizeInBytes);
-		memset(buffer->entities, 0, buffer->capacity * buffer->sizeInBytes);
+		GrowEntityTypeBuffer(buffer, info.defaultCapacity);
 	}
 }
-void* GetEntity(EntityFactory* entityFactory, EntityHandle handle) {
-	if (handle.indexInInfo >= entityFactory->entityCapacity) {
-		return NULL;
+
+// Every entity struct starts with Entity, so generic passes can read the
+// shared header of any type without knowing its struct.
+inline Entity* GetEntityBase(EntityTypeBuffer* buffer, int32 slot) {
+	return (Entity*)((u8*)buffer->entities + (buffer->sizeInBytes * slot));
+}
+
+// Slot of a live entity in its type's buffer and columns, or -1 for a stale handle.
+int32 GetEntityIndexInBuffer(EntityFactory* entityFactory, EntityHandle handle) {
+	if (handle.indexInInfo < 0 || handle.indexInInfo >= entityFactory->entityCapacity) {
+		return -1;
 	}
 
 	EntityInfo* info = &entityFactory->entities[handle.indexInInfo];
 
 	if (info->generation != handle.generation) {
-		return NULL;
+		return -1;
 	}
 	if (info->type != handle.type) {
+		return -1;
+	}
+
+	return info->indexInBuffer;
+}
+
+void* GetEntity(EntityFactory* entityFactory, EntityHandle handle) {
+	int32 indexInBuffer = GetEntityIndexInBuffer(entityFactory, handle);
+	if (indexInBuffer < 0) {
 		return NULL;
 	}
 
-	EntityTypeBuffer* buffer = &entityFactory->buffers[info->type];
+	EntityTypeBuffer* buffer = &entityFactory->buffers[handle.type];
 
-	return ((u8*)buffer->entities + (buffer->sizeInBytes * info->indexInBuffer));
+	return ((u8*)buffer->entities + (buffer->sizeInBytes * indexInBuffer));
 }
 
 
@@ -49,39 +118,386 @@ void InitEntityFactory(EntityFactory* entityFactory, Zayn* zaynMem) {
 
 	InitEntityTypeInfo(zaynMem);
 
-	entityFactory->entityCapacity = 100000;
-	entityFactory->entities = (EntityInfo*)malloc(sizeof(EntityInfo) * entityFactory->entityCapacity);
-	memset(entityFactory->entities, 0, sizeof(EntityInfo) * entityFactory->entityCapacity);
+	entityFactory->entities = NULL;
+	entityFactory->entityCapacity = 0;
 	entityFactory->nextID = 0;
+	GrowEntityInfos(entityFactory, ENTITY_INFO_INITIAL_CAPACITY);
+
+	entityFactory->freeList = MakeMArray<int32>(&zaynMem->generalMemory, ENTITY_INFO_INITIAL_CAPACITY, MemoryTag_Entity);
 
-	entityFactory->activeEntityHandles = MakeDynamicArray<EntityHandle>(&zaynMem->permanentMemory, 5000);
+	for (int32 i = 0; i < MAX_TRANSFORM_DEPTH; i++) {
+		entityFactory->transformLevels[i] = MakeMArray<EntityHandle>(&zaynMem->generalMemory, 0, MemoryTag_Entity);
+	}
+
+	entityFactory->renderEvents = MakeMArray<RenderEvent>(&zaynMem->generalMemory, ENTITY_INFO_INITIAL_CAPACITY, MemoryTag_Entity);
+
+	entityFactory->activeEntityHandles = MakeDynamicArray<EntityHandle>(&zaynMem->permanentMemory, 5000, 1, MemoryTag_Entity);
 	InitEntityBuffers(entityFactory);
 }
+// Creates count entities of one type in a single pass. Their slots are
+// contiguous, so the returned span aliases buffer->handles[firstIndexInBuffer..]
+// and the caller can fill the SoA columns over the same range. The span is
+// only valid until the next add or remove on this type.
+EntityHandleSpan AddEntities(EntityFactory* entityFactory, EntityType type, int32 count) {
+	EntityTypeBuffer* buffer = &entityFactory->buffers[type];
+
+	if (buffer->count + count > buffer->capacity) {
+		int32 newCapacity = buffer->capacity ? buffer->capacity * 2 : 16;
+		while (newCapacity < buffer->count + count) {
+			newCapacity *= 2;
+		}
+		GrowEntityTypeBuffer(buffer, newCapacity);
+	}
+
+	int32 recycledCount = count < (int32)entityFactory->freeList.count ? count : (int32)entityFactory->freeList.count;
+	int32 freshCount = count - recycledCount;
+	if (entityFactory->nextID + freshCount > entityFactory->entityCapacity) {
+		int32 newCapacity = entityFactory->entityCapacity * 2;
+		while (newCapacity < entityFactory->nextID + freshCount) {
+			newCapacity *= 2;
+		}
+		GrowEntityInfos(entityFactory, newCapacity);
+	}
+
+	int32 firstSlot = buffer->count;
+	buffer->count += count;
+
+	for (int32 i = 0; i < count; i++) {
+		int32 indexInInfo;
+		if (i < recycledCount) {
+			indexInInfo = Last(&entityFactory->freeList);
+			entityFactory->freeList.count--;
+		}
+		else {
+			indexInInfo = entityFactory->nextID;
+			entityFactory->nextID++;
+		}
+
+		EntityInfo* info = &entityFactory->entities[indexInInfo];
+		info->type = type;
+		info->generation++;
+		info->indexInBuffer = firstSlot + i;
+
+		EntityHandle* handle = &buffer->handles[firstSlot + i];
+		handle->generation = info->generation;
+		handle->indexInInfo = indexInInfo;
+		handle->type = type;
+	}
+
+	// Slots are reused after RemoveEntity, so start from clean ones.
+	memset((u8*)buffer->entities + (buffer->sizeInBytes * firstSlot), 0, buffer->sizeInBytes * count);
+	memset(buffer->positions + firstSlot, 0, sizeof(vec3) * count);
+	memset(buffer->rotations + firstSlot, 0, sizeof(vec3) * count);
+	memset(buffer->meshes + firstSlot, 0, sizeof(Mesh*) * count);
+	memset(buffer->materials + firstSlot, 0, sizeof(Material*) * count);
+	memset(buffer->isStatic + firstSlot, entityFactory->entityTypeInfoForBuffer[type].isStaticByDefault, sizeof(bool) * count);
+	memset(buffer->parents + firstSlot, 0, sizeof(EntityHandle) * count);
+	memset(buffer->depths + firstSlot, 0, sizeof(u8) * count);
+	memset(buffer->transformFlags + firstSlot, TransformFlag_LocalDirty, sizeof(u8) * count);
+	for (int32 i = 0; i < count; i++) {
+		buffer->scales[firstSlot + i] = V3(1, 1, 1);
+		buffer->levelIndices[firstSlot + i] = -1;
+
+		Entity* entity = GetEntityBase(buffer, firstSlot + i);
+		entity->type = type;
+		entity->isActive = true;
+		entity->handle = buffer->handles[firstSlot + i];
+
+		RenderEvent event = {};
+		event.type = RenderEvent_Created;
+		event.handle = buffer->handles[firstSlot + i];
+		PushBack(&entityFactory->renderEvents, event);
+	}
+
+	EntityHandleSpan span = {};
+	span.handles = buffer->handles + firstSlot;
+	span.count = count;
+	span.firstIndexInBuffer = firstSlot;
+	return span;
+}
+
 EntityHandle AddEntity(EntityFactory* entityFactory, EntityType type) {
-	int32 nextFreeIdInIndex = entityFactory->nextID;
+	return AddEntities(entityFactory, type, 1).handles[0];
+}
 
-	if (entityFactory->freeListCount > 0) {
-		nextFreeIdInIndex = entityFactory->freeList[entityFactory->freeListCount - 1];
-		entityFactory->freeListCount--;
+// Changes which mesh+material batch an entity is drawn from. Writing the
+// columns directly is only safe in the frame the entity was created.
+void SetEntityRenderable(EntityFactory* entityFactory, EntityHandle handle, Mesh* mesh, Material* material) {
+	int32 slot = GetEntityIndexInBuffer(entityFactory, handle);
+	if (slot < 0) {
+		return;
 	}
-	else {
-		entityFactory->nextID++;
+
+	EntityTypeBuffer* buffer = &entityFactory->buffers[handle.type];
+	if (buffer->meshes[slot] == mesh && buffer->materials[slot] == material) {
+		return;
 	}
 
-	EntityInfo* info = &entityFactory->entities[nextFreeIdInIndex];
-	info->type = type;
-	info->generation++;
+	RenderEvent event = {};
+	event.type = RenderEvent_Changed;
+	event.handle = handle;
+	event.isStatic = buffer->isStatic[slot];
+	PushBack(&entityFactory->renderEvents, event);
 
-	EntityTypeBuffer* buffer = &entityFactory->buffers[type];
-	info->indexInBuffer = buffer->count;
-	buffer->count++;
+	buffer->meshes[slot] = mesh;
+	buffer->materials[slot] = material;
+}
+
+inline void MarkTransformDirty(EntityTypeBuffer* buffer, int32 slot) {
+	buffer->transformFlags[slot] |= TransformFlag_LocalDirty;
+}
+
+// Call after writing an entity's position, rotation or scale columns.
+void MarkEntityTransformDirty(EntityFactory* entityFactory, EntityHandle handle) {
+	int32 slot = GetEntityIndexInBuffer(entityFactory, handle);
+	if (slot >= 0) {
+		MarkTransformDirty(&entityFactory->buffers[handle.type], slot);
+	}
+}
+
+inline bool HasParent(EntityTypeBuffer* buffer, int32 slot) {
+	return buffer->parents[slot].generation != 0;
+}
+
+void AddToTransformLevel(EntityFactory* entityFactory, EntityTypeBuffer* buffer, int32 slot, u8 depth) {
+	buffer->depths[slot] = depth;
+	buffer->levelIndices[slot] = -1;
+	if (depth > 0) {
+		buffer->levelIndices[slot] = (int32)PushBack(&entityFactory->transformLevels[depth - 1], buffer->handles[slot]);
+	}
+}
+
+void RemoveFromTransformLevel(EntityFactory* entityFactory, EntityTypeBuffer* buffer, int32 slot) {
+	u8 depth = buffer->depths[slot];
+	if (depth == 0) {
+		return;
+	}
+
+	MArray<EntityHandle>* level = &entityFactory->transformLevels[depth - 1];
+	uint32 index = (uint32)buffer->levelIndices[slot];
+	RemoveAtIndexBySwap(level, index);
+
+	if (index < level->count) {
+		EntityHandle moved = (*level)[index];
+		int32 movedSlot = GetEntityIndexInBuffer(entityFactory, moved);
+		entityFactory->buffers[moved.type].levelIndices[movedSlot] = (int32)index;
+	}
+
+	buffer->depths[slot] = 0;
+	buffer->levelIndices[slot] = -1;
+}
+
+// Direct children sit one level below their parent, so only that level is scanned.
+void CollectTransformChildren(EntityFactory* entityFactory, EntityHandle parent, u8 parentDepth, MArray<EntityHandle>* children) {
+	if (parentDepth >= MAX_TRANSFORM_DEPTH) {
+		return;
+	}
+
+	for (EntityHandle candidate : entityFactory->transformLevels[parentDepth]) {
+		int32 candidateSlot = GetEntityIndexInBuffer(entityFactory, candidate);
+		if (entityFactory->buffers[candidate.type].parents[candidateSlot] == parent) {
+			PushBack(children, candidate);
+		}
+	}
+}
+
+// Levels below handle, counting handle itself as one.
+int32 GetTransformSubtreeHeight(EntityFactory* entityFactory, EntityHandle handle) {
+	int32 slot = GetEntityIndexInBuffer(entityFactory, handle);
+	MArray<EntityHandle> children = MakeMArray<EntityHandle>(0);
+	CollectTransformChildren(entityFactory, handle, entityFactory->buffers[handle.type].depths[slot], &children);
+
+	int32 height = 1;
+	for (EntityHandle child : children) {
+		int32 childHeight = GetTransformSubtreeHeight(entityFactory, child) + 1;
+		if (childHeight > height) {
+			height = childHeight;
+		}
+	}
+
+	DeallocateMArray(&children);
+	return height;
+}
+
+// Moves handle to depth and its descendants below it, flagging all of them
+// so their world matrices are rebuilt on the next update.
+void SetTransformSubtreeDepth(EntityFactory* entityFactory, EntityHandle handle, u8 depth) {
+	int32 slot = GetEntityIndexInBuffer(entityFactory, handle);
+	EntityTypeBuffer* buffer = &entityFactory->buffers[handle.type];
+
+	MArray<EntityHandle> children = MakeMArray<EntityHandle>(0);
+	CollectTransformChildren(entityFactory, handle, buffer->depths[slot], &children);
+
+	RemoveFromTransformLevel(entityFactory, buffer, slot);
+	AddToTransformLevel(entityFactory, buffer, slot, depth);
+	MarkTransformDirty(buffer, slot);
+
+	for (EntityHandle child : children) {
+		SetTransformSubtreeDepth(entityFactory, child, depth + 1);
+	}
+
+	DeallocateMArray(&children);
+}
+
+// Attaches child under parent, or makes it a root when parent is {}. The
+// child's position/rotation/scale are kept and read as parent-relative.
+bool SetEntityParent(EntityFactory* entityFactory, EntityHandle child, EntityHandle parent) {
+	int32 childSlot = GetEntityIndexInBuffer(entityFactory, child);
+	if (childSlot < 0) {
+		return false;
+	}
+
+	u8 newDepth = 0;
+	if (parent.generation != 0) {
+		int32 parentSlot = GetEntityIndexInBuffer(entityFactory, parent);
+		if (parentSlot < 0) {
+			return false;
+		}
+
+		// Refuse to parent an entity under its own descendant.
+		EntityHandle ancestor = parent;
+		while (ancestor.generation != 0) {
+			if (ancestor == child) {
+				printf("ERROR: SetEntityParent would create a cycle\n");
+				return false;
+			}
+			int32 ancestorSlot = GetEntityIndexInBuffer(entityFactory, ancestor);
+			ancestor = entityFactory->buffers[ancestor.type].parents[ancestorSlot];
+		}
+
+		newDepth = entityFactory->buffers[parent.type].depths[parentSlot] + 1;
+		if (newDepth + GetTransformSubtreeHeight(entityFactory, child) - 1 > MAX_TRANSFORM_DEPTH) {
+			printf("ERROR: SetEntityParent exceeds MAX_TRANSFORM_DEPTH (%d)\n", MAX_TRANSFORM_DEPTH);
+			return false;
+		}
+	}
+
+	entityFactory->buffers[child.type].parents[childSlot] = parent;
+	SetTransformSubtreeDepth(entityFactory, child, newDepth);
+	return true;
+}
+
+void DetachTransformChildren(EntityFactory* entityFactory, EntityHandle parent) {
+	int32 slot = GetEntityIndexInBuffer(entityFactory, parent);
+	MArray<EntityHandle> children = MakeMArray<EntityHandle>(0);
+	CollectTransformChildren(entityFactory, parent, entityFactory->buffers[parent.type].depths[slot], &children);
+
+	for (EntityHandle child : children) {
+		SetEntityParent(entityFactory, child, {});
+	}
+
+	DeallocateMArray(&children);
+}
+
+// Scheduler system, first pass: rebuilds local matrices for entities whose
+// transform columns changed. Roots get their world matrix here too.
+void UpdateLocalTransformsSystem(Zayn* zaynMem, EntityTypeBuffer* buffer, int32 first, int32 count, void* userData) {
+	for (int32 slot = first; slot < first + count; slot++) {
+		u8 flags = buffer->transformFlags[slot];
+		if (!(flags & TransformFlag_LocalDirty)) {
+			buffer->transformFlags[slot] = 0;
+			continue;
+		}
+
+		buffer->localMatrices[slot] = TRS(buffer->positions[slot], buffer->rotations[slot], buffer->scales[slot]);
+		if (buffer->depths[slot] == 0) {
+			buffer->worldMatrices[slot] = buffer->localMatrices[slot];
+		}
+		buffer->transformFlags[slot] = TransformFlag_WorldChanged;
+	}
+}
+
+// Scheduler system, second pass: walks the child levels breadth first and
+// rebuilds a world matrix only when the child or its parent changed.
+void PropagateWorldTransformsSystem(Zayn* zaynMem, EntityTypeBuffer* unused, int32 first, int32 count, void* userData) {
+	EntityFactory* entityFactory = &zaynMem->entityFactory;
+
+	for (int32 depth = 0; depth < MAX_TRANSFORM_DEPTH; depth++) {
+		for (EntityHandle handle : entityFactory->transformLevels[depth]) {
+			EntityTypeBuffer* buffer = &entityFactory->buffers[handle.type];
+			int32 slot = entityFactory->entities[handle.indexInInfo].indexInBuffer;
+
+			EntityHandle parent = buffer->parents[slot];
+			EntityTypeBuffer* parentBuffer = &entityFactory->buffers[parent.type];
+			int32 parentSlot = entityFactory->entities[parent.indexInInfo].indexInBuffer;
+
+			if ((buffer->transformFlags[slot] | parentBuffer->transformFlags[parentSlot]) & TransformFlag_WorldChanged) {
+				buffer->worldMatrices[slot] = parentBuffer->worldMatrices[parentSlot] * buffer->localMatrices[slot];
+				buffer->transformFlags[slot] |= TransformFlag_WorldChanged;
+			}
+		}
+	}
+}
+
+void RegisterTransformSystems(Zayn* zaynMem) {
+	SystemScheduler* scheduler = &zaynMem->systemScheduler;
+
+	SystemDesc localTransforms = {};
+	localTransforms.name = "UpdateLocalTransforms";
+	localTransforms.update = UpdateLocalTransformsSystem;
+	localTransforms.iterateTypes = ENTITY_TYPE_MASK_ALL;
+	localTransforms.access.writeTypes = ENTITY_TYPE_MASK_ALL;
+	RegisterSystem(scheduler, &localTransforms);
+
+	SystemDesc worldTransforms = {};
+	worldTransforms.name = "PropagateWorldTransforms";
+	worldTransforms.update = PropagateWorldTransformsSystem;
+	worldTransforms.access.writeTypes = ENTITY_TYPE_MASK_ALL;
+	RegisterSystem(scheduler, &worldTransforms);
+}
+
+// Destroys the entity: the last entity of the same type is moved into its
+// slot so the buffer stays dense, the generation is bumped so outstanding
+// handles go stale, and the id goes on the free list for reuse.
+bool RemoveEntity(EntityFactory* entityFactory, EntityHandle handle) {
+	int32 slot = GetEntityIndexInBuffer(entityFactory, handle);
+	if (slot < 0) {
+		return false;
+	}
+
+	EntityTypeBuffer* buffer = &entityFactory->buffers[handle.type];
+
+	// Children outlive their parent as roots, keeping their local transform.
+	DetachTransformChildren(entityFactory, handle);
+	RemoveFromTransformLevel(entityFactory, buffer, slot);
+
+	RenderEvent event = {};
+	event.type = RenderEvent_Destroyed;
+	event.handle = handle;
+	event.isStatic = buffer->isStatic[slot];
+	PushBack(&entityFactory->renderEvents, event);
+
+	int32 lastSlot = buffer->count - 1;
+
+	if (slot != lastSlot) {
+		memcpy((u8*)buffer->entities + (buffer->sizeInBytes * slot),
+		       (u8*)buffer->entities + (buffer->sizeInBytes * lastSlot),
+		       buffer->sizeInBytes);
+		buffer->positions[slot] = buffer->positions[lastSlot];
+		buffer->rotations[slot] = buffer->rotations[lastSlot];
+		buffer->scales[slot] = buffer->scales[lastSlot];
+		buffer->meshes[slot] = buffer->meshes[lastSlot];
+		buffer->materials[slot] = buffer->materials[lastSlot];
+		buffer->isStatic[slot] = buffer->isStatic[lastSlot];
+		buffer->handles[slot] = buffer->handles[lastSlot];
+		buffer->parents[slot] = buffer->parents[lastSlot];
+		buffer->localMatrices[slot] = buffer->localMatrices[lastSlot];
+		buffer->worldMatrices[slot] = buffer->worldMatrices[lastSlot];
+		buffer->transformFlags[slot] = buffer->transformFlags[lastSlot];
+		buffer->depths[slot] = buffer->depths[lastSlot];
+		buffer->levelIndices[slot] = buffer->levelIndices[lastSlot];
+
+		entityFactory->entities[buffer->handles[slot].indexInInfo].indexInBuffer = slot;
+	}
+	buffer->count--;
+
+	EntityInfo* info = &entityFactory->entities[handle.indexInInfo];
+	info->generation++;
+	info->indexInBuffer = -1;
 
-	EntityHandle handle = {};
-	handle.generation = info->generation;
-	handle.indexInInfo = nextFreeIdInIndex;
-	handle.type = type;
+	PushBack(&entityFactory->freeList, handle.indexInInfo);
 
-	return handle;
+	return true;
 }
 
 // void MakeEntity()
@@ -19,14 +19,10 @@ struct EntityTypeInfoForBuffer
     int32 structSize;
     int32 defaultCapacity;
     const char* typeName;
+    bool isStaticByDefault;     // new entities are baked into static render batches
 };
 
 
-struct FreeList {
-    int32 freeList[1000];
-    int32 freelistCount;
-};
-
 struct EntityHandle
 {
 	int32 generation;
@@ -47,6 +43,16 @@ struct EntityHandle
         }
 };
 
+// Run of freshly created handles; see AddEntities.
+struct EntityHandleSpan {
+    EntityHandle* handles;
+    int32 count;
+    int32 firstIndexInBuffer;
+
+    inline EntityHandle* begin() const { return handles; }
+    inline EntityHandle* end() const { return handles + count; }
+};
+
 struct EntityInfo {
     int32 generation;
     int32 indexInBuffer;
@@ -54,12 +60,61 @@ struct EntityInfo {
     EntityType type;
 };
 
+struct Mesh;
+struct Material;
+
+#define ENTITY_COLUMN_ALIGNMENT 64
+
+// Deepest parent chain UpdateTransforms supports.
+#define MAX_TRANSFORM_DEPTH 8
+
+enum TransformFlag {
+    TransformFlag_LocalDirty   = 1 << 0,   // position/rotation/scale changed since the last update
+    TransformFlag_WorldChanged = 1 << 1,   // worldMatrices was rewritten by the last update
+};
+
+// Queued by the entity factory whenever an entity enters, leaves or changes
+// its mesh+material batch, so the renderer can patch its batches instead of
+// rebuilding them. isStatic is what the entity was batched under before the
+// event; Created events read the columns when applied.
+enum RenderEventType {
+    RenderEvent_Created,
+    RenderEvent_Destroyed,
+    RenderEvent_Changed,
+};
+
+struct RenderEvent {
+    RenderEventType type;
+    EntityHandle handle;
+    bool isStatic;
+};
+
 struct EntityTypeBuffer {
     int32 count;
     int32 capacity;
     int32 sizeInBytes;
 
-    void* entities;
+    void* entities; // per-type fields that no system streams over
+
+    // SoA columns shared by every entity type, indexed by EntityInfo::indexInBuffer.
+    // Each column is ENTITY_COLUMN_ALIGNMENT aligned so transform and culling
+    // passes can stream just the fields they read.
+    vec3* positions;
+    vec3* rotations;
+    vec3* scales;
+    Mesh** meshes;
+    Material** materials;
+    bool* isStatic;        // rarely moves; rendered from baked device-local batches, patched in place
+    EntityHandle* handles; // owner of each slot, for fix-up when a slot moves
+
+    // Transform hierarchy. positions/rotations/scales are relative to the
+    // parent; the matrices are cached and only rebuilt for dirty subtrees.
+    EntityHandle* parents;      // generation 0 for roots
+    mat4* localMatrices;
+    mat4* worldMatrices;
+    u8* transformFlags;         // TransformFlag_*
+    u8* depths;                 // 0 for roots
+    int32* levelIndices;        // index in EntityFactory::transformLevels[depth - 1], -1 for roots
 };
 
 
@@ -78,11 +133,20 @@ struct EntityFactory
     EntityTypeBuffer buffers[EntityType_Count];
     EntityTypeInfoForBuffer entityTypeInfoForBuffer[EntityType_Count];
 
+    // Grows on demand; handles index this through indexInInfo, so the
+    // buffers behind it can be reallocated without invalidating them.
     EntityInfo *entities;
     int32 entityCapacity;
 
-    int32 freeListCount;
-    int32 freeList[10000];
+    MArray<int32> freeList;
+
+    // Child entities grouped by depth; transformLevels[d] holds depth d + 1.
+    // Walking the levels in order visits the hierarchy breadth first, so a
+    // parent's world matrix is final before any child reads it.
+    MArray<EntityHandle> transformLevels[MAX_TRANSFORM_DEPTH];
+
+    // Drained once per frame by the ApplyRenderEvents system.
+    MArray<RenderEvent> renderEvents;
 
 
     int32 nextID;
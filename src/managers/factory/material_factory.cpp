@@ -250,5 +250,10 @@ void CreateBasicLightingMaterials(Zayn* zaynMem) {
 
 void InitMaterialFactory(Zayn* zaynMem)
 {
-    zaynMem->materialFactory.materials = MakeDynamicArray<Material>(&zaynMem->permanentMemory, 100);
+    zaynMem->materialFactory.materials = MakeDynamicArray<Material>(&zaynMem->permanentMemory, 100, 1, MemoryTag_Material);
+    InitMemoryPool(&zaynMem->materialFactory.batchPool, &zaynMem->permanentMemory, sizeof(MaterialMeshBatch), 64);
+    zaynMem->materialFactory.batchInstanceRefs = MakeMArray<BatchInstanceRef>(&zaynMem->generalMemory, ENTITY_INFO_INITIAL_CAPACITY, MemoryTag_Material);
+    zaynMem->materialFactory.drawOrder = MakeMArray<MaterialMeshBatch*>(&zaynMem->generalMemory, 64, MemoryTag_Material);
+    zaynMem->materialFactory.staticInstanceRefs = MakeMArray<StaticInstanceRef>(&zaynMem->generalMemory, ENTITY_INFO_INITIAL_CAPACITY, MemoryTag_Material);
+    zaynMem->materialFactory.staticPatches = MakeMArray<StaticInstancePatch>(&zaynMem->generalMemory, 64, MemoryTag_Material);
 }
@@ -40,21 +40,106 @@ struct Material {
     bool isInitialized = false;
 };
 
+// Instances covered by one bit of MaterialMeshBatch::dirtyBlocks.
+#define BATCH_DIRTY_BLOCK_SIZE 64
+
+// World-space bounding spheres of a batch's instances, one array per
+// component for CullSpheres. Counts are kept padded to a multiple of four.
+struct InstanceBounds {
+    MArray<real32> centerX;
+    MArray<real32> centerY;
+    MArray<real32> centerZ;
+    MArray<real32> radius;
+};
+
 struct MaterialMeshBatch {
     Mesh* mesh;
     Material* material;
     
-    // Instance data for this specific mesh-material combination
-    VkBuffer instanceBuffer;
-    VkDeviceMemory instanceBufferMemory;
-    void* instanceBufferMapped;
+    // Dynamic instances occupy [instanceFirst, instanceFirst + maxInstances)
+    // of every ring region of BatchStorage::instanceBuffer. The range doubles
+    // when it fills up and may move when the storage is packed.
+    uint32_t instanceFirst;
     uint32_t maxInstances;
     
-    // Current instances
-    DynamicArray<InstancedData> instanceData;
+    // Current dynamic instances, patched by ApplyRenderEvents rather than rebuilt
+    DynamicArray<InstanceTransform> instanceData;
     DynamicArray<EntityHandle> registeredEntities;
     uint32_t instanceCount;
-    bool instanceDataRequiresGpuUpdate;
+
+    // Bit b of dirtyBlocks[f] is set when a slot in block b changed since
+    // ring region f was last written.
+    MArray<uint64> dirtyBlocks[MAX_FRAMES_IN_FLIGHT];
+    InstanceBounds bounds;
+
+    // Static instances, baked into [staticFirst, staticFirst + staticInstanceCount)
+    // of BatchStorage::staticInstanceBuffer by BakeStaticBatches
+    uint32_t staticFirst;
+    uint32_t staticInstanceCount;
+    InstanceBounds staticBounds;
+    uint32_t staticUploadCursor;    // only used while baking
+};
+
+// The GPU side of every batch. Batches own ranges of these shared buffers
+// rather than buffers of their own, so culling is one dispatch and each
+// material's batches of one vertex format are one multi-draw.
+struct BatchStorage {
+    // Dynamic InstanceTransforms: host-visible ring of MAX_FRAMES_IN_FLIGHT
+    // regions of instanceCapacity, so a frame never writes instances the GPU
+    // may still be reading for an earlier frame.
+    VkBuffer instanceBuffer;
+    VkDeviceMemory instanceBufferMemory;
+    void* instanceBufferMapped;
+    VkDeviceSize instanceBufferMemorySize;
+    bool instanceBufferCoherent;    // otherwise written ranges are flushed
+    uint32_t instanceCapacity;
+    uint32_t instanceUsed;          // batch ranges are bump-allocated and packed when full
+
+    // Baked static InstanceTransforms, device-local. Never empty, so the
+    // descriptor always has a buffer to point at.
+    VkBuffer staticInstanceBuffer;
+    VkDeviceMemory staticInstanceBufferMemory;
+    uint32_t staticCapacity;
+
+    // Frustum culling writes the indices of visible instances here each
+    // frame, regions of visibleCapacity; the shaders read transforms through them.
+    VkBuffer visibleBuffer;
+    VkDeviceMemory visibleBufferMemory;
+    uint32* visibleBufferMapped;
+    uint32_t visibleCapacity;
+
+    // One indirect draw and one CullRange per batch a frame, regions of batchCapacity
+    VkBuffer commandBuffer;
+    VkDeviceMemory commandBufferMemory;
+    VkDrawIndexedIndirectCommand* commandsMapped;
+    VkBuffer rangeBuffer;
+    VkDeviceMemory rangeBufferMemory;
+    CullRange* rangesMapped;
+    uint32_t batchCapacity;
+
+    // Set 1 of the batch pipelines and set 0 of the cull pipeline; rewritten
+    // whenever a buffer above is replaced.
+    VkDescriptorSet descriptorSet;
+};
+
+// Where an entity's dynamic instance lives; batch is NULL when it has none.
+struct BatchInstanceRef {
+    MaterialMeshBatch* batch;
+    uint32 slot;
+};
+
+// Where a baked static entity's instance lives; batch is NULL when the
+// entity was not baked or its instance has been hidden since.
+struct StaticInstanceRef {
+    MaterialMeshBatch* batch;
+    uint32 slot;            // into the batch's static range
+    EntityHandle handle;
+};
+
+// A write into BatchStorage::staticInstanceBuffer still to be recorded.
+struct StaticInstancePatch {
+    uint32 index;
+    InstanceTransform transform;
 };
 
 // Hash function for std::pair<Mesh*, Material*>
@@ -76,5 +161,28 @@ struct MaterialFactory
     
     // Store all material-mesh combinations for batching
     std::unordered_map<std::pair<Mesh*, Material*>, MaterialMeshBatch*, MaterialMeshPairHash> materialMeshBatches;
+    MemoryPool batchPool;
+    BatchStorage batchStorage;
+
+    // Every batch, sorted by pipeline, vertex format and material so batches
+    // that can share a multi-draw are adjacent.
+    MArray<MaterialMeshBatch*> drawOrder;
+
+    // Reverse index from EntityHandle::indexInInfo to the batch instance that
+    // draws the entity, kept current across swap-removes.
+    MArray<BatchInstanceRef> batchInstanceRefs;
+
+    // Baked static instances by EntityHandle::indexInInfo. Moving a baked
+    // entity patches its instance and destroying or rebatching it hides the
+    // instance; the patches are recorded by CullMaterialBatches. Static
+    // entities created or rebatched after the bake are drawn as dynamic
+    // instances until the next one.
+    MArray<StaticInstanceRef> staticInstanceRefs;
+    MArray<StaticInstancePatch> staticPatches;
+
+    // Set to rebake the static batches, e.g. once a level has loaded; the
+    // bake waits for the device to go idle.
+    uint32 staticInstancesBaked;
+    bool staticBatchesDirty;
 };
 
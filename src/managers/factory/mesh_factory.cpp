@@ -13,6 +13,9 @@ struct MeshCreationInfo
     std::string path;
     std::string name;
 
+    // VertexFormat_Compact is a request: meshes the compact format can't
+    // represent (UVs outside [0, 1], positions past half precision) stay float.
+    VertexFormat vertexFormat;
 };
 
 std::string GetTexturePath(const std::string& filename) {
@@ -77,57 +80,6 @@ std::string GetModelPath(const std::string& filename) {
     return relativePath;
 }
 
-void CreateIndexBuffer(Renderer* renderer, std::vector<uint32_t> indices, VkBuffer* indexBuffer, VkDeviceMemory* indexBufferMemory)
-{
-    if (indices.empty())
-    {
-        return;
-    }
-    VkDeviceSize bufferSize = sizeof(uint32_t) * indices.size();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(renderer->data.vkDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), (size_t)bufferSize);
-    vkUnmapMemory(renderer->data.vkDevice, stagingBufferMemory);
-
-    CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, *indexBuffer, *indexBufferMemory);
-
-    CopyBuffer(renderer, stagingBuffer, *indexBuffer, bufferSize);
-
-    vkDestroyBuffer(renderer->data.vkDevice, stagingBuffer, nullptr);
-    vkFreeMemory(renderer->data.vkDevice, stagingBufferMemory, nullptr);
-}
-
-void CreateVertexBuffer(Renderer* renderer, std::vector<Vertex>& vertices, VkBuffer* vertexBuffer, VkDeviceMemory* vertexBufferMemory)
-{
-    if (vertices.empty())
-    {
-        return;
-    }
-
-    VkDeviceSize bufferSize = sizeof(Vertex) * vertices.size();
-    // STAGING BUFFER - CPU accessible memory to upload the data from the vertex array to.
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(renderer->data.vkDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(renderer->data.vkDevice, stagingBufferMemory);
-
-    CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, *vertexBuffer, *vertexBufferMemory);
-
-    CopyBuffer(renderer,stagingBuffer, *vertexBuffer, bufferSize);
-
-    vkDestroyBuffer(renderer->data.vkDevice, stagingBuffer, nullptr);
-    vkFreeMemory(renderer->data.vkDevice, stagingBufferMemory, nullptr);
-}
-
 void LoadModel(std::string modelPath, std::vector<Vertex>* vertices, std::vector<uint32_t>* indices) {
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
@@ -158,8 +110,15 @@ void LoadModel(std::string modelPath, std::vector<Vertex>* vertices, std::vector
 
             vertex.color = { 0.3f, 1.0f, 0.6f };
 
-            // Set default normal (pointing up in Y direction)
+            // Default normal (pointing up in Y direction) when the file has none
             vertex.normal = { 0.0f, 1.0f, 0.0f };
+            if (index.normal_index >= 0)
+            {
+                vertex.normal = {
+                    attrib.normals[3 * index.normal_index + 0],
+                    attrib.normals[3 * index.normal_index + 1],
+                    attrib.normals[3 * index.normal_index + 2] };
+            }
 
             if (uniqueVertices.count(vertex) == 0)
             {
@@ -174,24 +133,131 @@ void LoadModel(std::string modelPath, std::vector<Vertex>* vertices, std::vector
 
 }
 
-void EnableMeshInstancing(Zayn* zaynMem, Mesh* mesh, uint32_t maxInstances) {
-    if (mesh->supportsInstancing) return;
+// Octahedral normal encoding: the unit vector is projected onto the L1 sphere
+// and the lower hemisphere folded over the diagonals, giving two values in [-1, 1].
+// OctahedralDecode in the vertex shaders inverts it.
+glm::vec2 OctahedralEncode(glm::vec3 n) {
+    n /= (fabsf(n.x) + fabsf(n.y) + fabsf(n.z));
+    glm::vec2 result = glm::vec2(n.x, n.y);
+    if (n.z < 0.0f) {
+        result.x = (1.0f - fabsf(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+        result.y = (1.0f - fabsf(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return result;
+}
+
+// Packs vertices into VertexCompact. Returns false, leaving compact untouched,
+// when the mesh doesn't fit: UVs outside [0, 1] would clamp (no tiling in
+// unorm16) and half positions must stay within 1/1024 of the mesh's extent.
+bool CompactVertices(const std::vector<Vertex>& vertices, std::vector<VertexCompact>* compact) {
+    if (vertices.empty()) {
+        return false;
+    }
 
-    Renderer* renderer = &zaynMem->renderer;
-    mesh->supportsInstancing = true;
-    mesh->maxInstances = maxInstances;
-    mesh->instanceCount = 0;
+    glm::vec3 boundsMin = vertices[0].pos;
+    glm::vec3 boundsMax = vertices[0].pos;
+    for (const Vertex& vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.pos);
+        boundsMax = glm::max(boundsMax, vertex.pos);
+    }
+    glm::vec3 extent = boundsMax - boundsMin;
+    real32 maxPositionError = glm::max(extent.x, glm::max(extent.y, extent.z)) / 1024.0f;
+
+    std::vector<VertexCompact> result(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); i++) {
+        const Vertex& vertex = vertices[i];
+        VertexCompact* packed = &result[i];
+
+        if (vertex.texCoord.x < 0.0f || vertex.texCoord.x > 1.0f ||
+            vertex.texCoord.y < 0.0f || vertex.texCoord.y > 1.0f) {
+            return false;
+        }
+
+        packed->posXY = glm::packHalf2x16(glm::vec2(vertex.pos.x, vertex.pos.y));
+        packed->posZW = glm::packHalf2x16(glm::vec2(vertex.pos.z, 1.0f));
+
+        glm::vec3 decoded = glm::vec3(glm::unpackHalf2x16(packed->posXY), glm::unpackHalf2x16(packed->posZW).x);
+        glm::vec3 error = glm::abs(decoded - vertex.pos);
+        if (error.x > maxPositionError || error.y > maxPositionError || error.z > maxPositionError) {
+            return false;
+        }
 
-    mesh->instanceData = MakeDynamicArray<InstancedData>(&zaynMem->permanentMemory, maxInstances);
-    mesh->registeredEntities = MakeDynamicArray<EntityHandle>(&zaynMem->permanentMemory, maxInstances);
+        packed->color = glm::packUnorm4x8(glm::vec4(vertex.color, 1.0f));
+        packed->texCoord = glm::packUnorm2x16(vertex.texCoord);
+        packed->normal = glm::packSnorm2x16(OctahedralEncode(vertex.normal));
+    }
+
+    *compact = std::move(result);
+    return true;
+}
 
-    VkDeviceSize bufferSize = sizeof(InstancedData) * maxInstances;
-    CreateBuffer(renderer, bufferSize,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        mesh->instanceBuffer, mesh->instanceBufferMemory);
+void ComputeMeshBounds(Mesh* mesh) {
+    mesh->boundsMin = V3(0.0f);
+    mesh->boundsMax = V3(0.0f);
+    if (mesh->vertices.empty()) return;
 
-    vkMapMemory(renderer->data.vkDevice, mesh->instanceBufferMemory, 0, bufferSize, 0, &mesh->instanceBufferMapped);
+    glm::vec3 boundsMin = mesh->vertices[0].pos;
+    glm::vec3 boundsMax = mesh->vertices[0].pos;
+    for (const Vertex& vertex : mesh->vertices) {
+        boundsMin = glm::min(boundsMin, vertex.pos);
+        boundsMax = glm::max(boundsMax, vertex.pos);
+    }
+    mesh->boundsMin = V3(boundsMin.x, boundsMin.y, boundsMin.z);
+    mesh->boundsMax = V3(boundsMax.x, boundsMax.y, boundsMax.z);
+}
+
+// Sub-allocates the mesh's vertices and indices from the renderer's geometry
+// pool and uploads them there.
+void UploadMeshGeometry(Renderer* renderer, Mesh* mesh) {
+    GeometryPool* pool = &renderer->data.vkGeometryPool;
+    VertexFormat format = mesh->vertexFormat;
+    mesh->indexCount = static_cast<uint32_t>(mesh->indices.size());
+
+    if (pool->vertexCount[format] + mesh->vertexCount > GEOMETRY_POOL_VERTICES ||
+        pool->indexCount + mesh->indexCount > GEOMETRY_POOL_INDICES) {
+        throw std::runtime_error("geometry pool is full!");
+    }
+
+    mesh->vertexBuffer = pool->vertexBuffers[format];
+    mesh->indexBuffer = pool->indexBuffer;
+    mesh->vertexOffset = static_cast<int32_t>(pool->vertexCount[format]);
+    mesh->firstIndex = pool->indexCount;
+
+    uint32_t stride = GetVertexStride(format);
+    const void* vertexData = format == VertexFormat_Compact ? (const void*)mesh->compactVertices.data()
+                                                            : (const void*)mesh->vertices.data();
+    if (mesh->vertexCount > 0) {
+        UploadToBuffer(renderer, vertexData, (VkDeviceSize)stride * mesh->vertexCount,
+                       mesh->vertexBuffer, (VkDeviceSize)stride * mesh->vertexOffset);
+    }
+    if (mesh->indexCount > 0) {
+        UploadToBuffer(renderer, mesh->indices.data(), sizeof(uint32_t) * mesh->indexCount,
+                       mesh->indexBuffer, sizeof(uint32_t) * mesh->firstIndex);
+    }
+
+    pool->vertexCount[format] += mesh->vertexCount;
+    pool->indexCount += mesh->indexCount;
+}
+
+// Converts mesh->vertices to the requested format and places the mesh in the
+// geometry pool. Bounds are taken first, while the float positions are still around.
+void CreateMeshGeometry(Renderer* renderer, Mesh* mesh, VertexFormat requestedFormat) {
+    ComputeMeshBounds(mesh);
+
+    mesh->vertexFormat = VertexFormat_Float;
+    mesh->vertexCount = static_cast<uint32_t>(mesh->vertices.size());
+
+    if (requestedFormat == VertexFormat_Compact) {
+        if (CompactVertices(mesh->vertices, &mesh->compactVertices)) {
+            mesh->vertexFormat = VertexFormat_Compact;
+            mesh->vertices.clear();
+            mesh->vertices.shrink_to_fit();
+        } else {
+            printf("Mesh %s doesn't fit the compact vertex format, keeping float vertices\n", mesh->name.c_str());
+        }
+    }
+
+    UploadMeshGeometry(renderer, mesh);
 }
 
 Mesh* MakeMesh(Zayn* zaynMem, MeshCreationInfo* info) {
@@ -200,16 +266,13 @@ Mesh* MakeMesh(Zayn* zaynMem, MeshCreationInfo* info) {
     mesh.path = info->path;
     mesh.name = info->name;
     LoadModel(mesh.path, &mesh.vertices, &mesh.indices);
-    CreateVertexBuffer(renderer, mesh.vertices, &mesh.vertexBuffer, &mesh.vertexBufferMemory);
-    CreateIndexBuffer(renderer, mesh.indices, &mesh.indexBuffer, &mesh.indexBufferMemory);
+    CreateMeshGeometry(renderer, &mesh, info->vertexFormat);
 
     uint32_t meshIndex = PushBack(&zaynMem->meshFactory.meshes, mesh);
     Mesh* pointerToStoredMesh = &zaynMem->meshFactory.meshes[meshIndex];
     zaynMem->meshFactory.meshNamePointerMap[mesh.name] = pointerToStoredMesh;
     zaynMem->meshFactory.availableMeshNames.push_back(mesh.name);
 
-    EnableMeshInstancing(zaynMem, pointerToStoredMesh, 100);
-
     return pointerToStoredMesh;
 }
 
@@ -254,16 +317,13 @@ Mesh* CreateProceduralWall(Zayn* zaynMem, float width, float height, float thick
         4, 0, 1,  4, 1, 5
     };
     
-    CreateVertexBuffer(renderer, mesh.vertices, &mesh.vertexBuffer, &mesh.vertexBufferMemory);
-    CreateIndexBuffer(renderer, mesh.indices, &mesh.indexBuffer, &mesh.indexBufferMemory);
+    CreateMeshGeometry(renderer, &mesh, VertexFormat_Float);
     
     uint32_t meshIndex = PushBack(&zaynMem->meshFactory.meshes, mesh);
     Mesh* pointerToStoredMesh = &zaynMem->meshFactory.meshes[meshIndex];
     zaynMem->meshFactory.meshNamePointerMap[mesh.name] = pointerToStoredMesh;
     zaynMem->meshFactory.availableMeshNames.push_back(mesh.name);
     
-    EnableMeshInstancing(zaynMem, pointerToStoredMesh, 100);
-    
     return pointerToStoredMesh;
 }
 
@@ -317,19 +377,16 @@ Mesh* CreateProceduralPlane(Zayn* zaynMem, float width, float height, int subdiv
     mesh.vertices = vertices;
     mesh.indices = indices;
     
-    CreateVertexBuffer(renderer, mesh.vertices, &mesh.vertexBuffer, &mesh.vertexBufferMemory);
-    CreateIndexBuffer(renderer, mesh.indices, &mesh.indexBuffer, &mesh.indexBufferMemory);
+    CreateMeshGeometry(renderer, &mesh, VertexFormat_Float);
     
     uint32_t meshIndex = PushBack(&zaynMem->meshFactory.meshes, mesh);
     Mesh* pointerToStoredMesh = &zaynMem->meshFactory.meshes[meshIndex];
     zaynMem->meshFactory.meshNamePointerMap[mesh.name] = pointerToStoredMesh;
     zaynMem->meshFactory.availableMeshNames.push_back(mesh.name);
     
-    EnableMeshInstancing(zaynMem, pointerToStoredMesh, 100);
-    
     return pointerToStoredMesh;
 }
 
 void InitMeshFactory(MeshFactory* meshFactory, MemoryArena* arena) {
-    meshFactory->meshes = MakeDynamicArray<Mesh>(arena, 100);
+    meshFactory->meshes = MakeDynamicArray<Mesh>(arena, 100, 1, MemoryTag_Mesh);
 }
\ No newline at end of file
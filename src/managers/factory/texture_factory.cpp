@@ -22,7 +22,7 @@ void CreateTextureImage(Renderer* renderer, uint32_t& mipLevels, VkImage* textur
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
 
-    CreateBuffer(renderer, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    CreateBuffer(renderer, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, MemoryTag_Texture);
     void* data;
     vkMapMemory(renderer->data.vkDevice, stagingBufferMemory, 0, imageSize, 0, &data);
     memcpy(data, pixels, static_cast<size_t>(imageSize));
@@ -30,14 +30,14 @@ void CreateTextureImage(Renderer* renderer, uint32_t& mipLevels, VkImage* textur
 
     stbi_image_free(pixels);
 
-    CreateImage(texWidth, texHeight, mipLevels, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, *textureImage, *textureImageMemory, renderer); // added
+    CreateImage(texWidth, texHeight, mipLevels, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, *textureImage, *textureImageMemory, renderer, MemoryTag_Texture); // added
 
     // TransitionImageLayout(zaynMem->vkTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, zaynMem);
     TransitionImageLayout(renderer, *textureImage, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
     CopyBufferToImage(renderer, stagingBuffer, *textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
 
     vkDestroyBuffer(renderer->data.vkDevice, stagingBuffer, nullptr);
-    vkFreeMemory(renderer->data.vkDevice, stagingBufferMemory, nullptr);
+    FreeDeviceMemory(renderer, stagingBufferMemory);
     GenerateMipmaps(renderer, *textureImage, format, texWidth, texHeight, mipLevels);
 }
 
@@ -89,5 +89,5 @@ Texture* MakeTexture(Zayn* zaynMem, TextureCreateInfo* info)
 }
 void InitTextureFactory(Zayn* zaynMem)
 {
-    zaynMem->textureFactory.textures = MakeDynamicArray<Texture>(&zaynMem->permanentMemory, 100);
+    zaynMem->textureFactory.textures = MakeDynamicArray<Texture>(&zaynMem->permanentMemory, 100, 1, MemoryTag_Texture);
 }
\ No newline at end of file
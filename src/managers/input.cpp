@@ -7,7 +7,7 @@ void AllocateInputManager(InputManager *inputManager, MemoryArena *arena, int32
 {
     // Use a reasonable chunk size (e.g., 64 or 128 events per chunk)
     const int EVENTS_PER_CHUNK = 128;  // Don't use deviceCapacity (5) as chunk size!
-    inputManager->events = MakeDynamicArray<InputEvent>(arena, EVENTS_PER_CHUNK);
+    inputManager->events = MakeDynamicArray<InputEvent>(arena, EVENTS_PER_CHUNK, 1, MemoryTag_Input);
 
     inputManager->deviceCount = deviceCapacity;
     inputManager->devices = (InputDevice *)AllocateMem(arena, sizeof(InputDevice) * deviceCapacity);
@@ -28,6 +28,8 @@ void InitLevelEditor(LevelEditor* editor) {
     
     // Initialize light creation settings
     editor->lightColorForCreation = V3(1, 1, 1);  // Default white light
+
+    editor->showMemoryWindow = false;
 }
 
 void SelectEntity(LevelEditor* editor, EntityHandle handle, EntityType type) {
@@ -52,8 +54,9 @@ void UpdateSelectedEntityTransform(Zayn* zaynMem, LevelEditor* editor) {
     
     // Only handle walls for now
     if (editor->selectedEntity.type == EntityType_Wall) {
-        WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
-        if (!wall) return;
+        int32 slot = GetEntityIndexInBuffer(&zaynMem->entityFactory, handle);
+        if (slot < 0) return;
+        EntityTypeBuffer* walls = &zaynMem->entityFactory.buffers[EntityType_Wall];
         
         vec3 positionDelta = V3(0, 0, 0);
         vec3 rotationDelta = V3(0, 0, 0);
@@ -103,28 +106,12 @@ void UpdateSelectedEntityTransform(Zayn* zaynMem, LevelEditor* editor) {
             needsUpdate = true;
         }
         
-        // Update transform if changed
+        // Update transform if changed. The transform systems rebuild the world
+        // matrix and SyncRenderTransforms writes it to the entity's batch slot.
         if (needsUpdate) {
-            wall->position = wall->position + positionDelta;
-            wall->rotation = wall->rotation + rotationDelta;
-            
-            // Update the mesh instance transform
-            if (wall->mesh) {
-                std::cout << "wall update" << std::endl;
-                std::cout << positionDelta.x << ", " << positionDelta.y << ", " << positionDelta.z << std::endl;
-                // Find and update the mesh instance
-                for (uint32 i = 0; i < wall->mesh->instanceCount; i++) {
-                    EntityHandle instanceHandle = wall->mesh->registeredEntities[i];
-                    if (instanceHandle.indexInInfo == handle.indexInInfo && 
-                        instanceHandle.generation == handle.generation) {
-                        
-                        mat4 newTransform = TRS(wall->position, wall->rotation, wall->scale);
-                        wall->mesh->instanceData[i].modelMatrix = newTransform;
-                        wall->mesh->instanceDataRequiresGpuUpdate = true;
-                        break;
-                    }
-                }
-            }
+            walls->positions[slot] = walls->positions[slot] + positionDelta;
+            walls->rotations[slot] = walls->rotations[slot] + rotationDelta;
+            MarkTransformDirty(walls, slot);
         }
     }
 }
@@ -138,25 +125,6 @@ void DeleteSelectedEntity(Zayn* zaynMem, LevelEditor* editor) {
         WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
         if (!wall) return;
         
-        // Remove from mesh instances
-        if (wall->mesh) {
-            for (uint32 i = 0; i < wall->mesh->instanceCount; i++) {
-                EntityHandle instanceHandle = wall->mesh->registeredEntities[i];
-                if (instanceHandle.indexInInfo == handle.indexInInfo && 
-                    instanceHandle.generation == handle.generation) {
-                    
-                    // Remove instance by swapping with last
-                    if (i < wall->mesh->instanceCount - 1) {
-                        wall->mesh->instanceData[i] = wall->mesh->instanceData[wall->mesh->instanceCount - 1];
-                        wall->mesh->registeredEntities[i] = wall->mesh->registeredEntities[wall->mesh->instanceCount - 1];
-                    }
-                    wall->mesh->instanceCount--;
-                    wall->mesh->instanceDataRequiresGpuUpdate = true;
-                    break;
-                }
-            }
-        }
-        
         // Remove from walls array
         for (uint32 i = 0; i < zaynMem->gameData.walls.count; i++) {
             EntityHandle wallHandle = zaynMem->gameData.walls[i];
@@ -172,8 +140,9 @@ void DeleteSelectedEntity(Zayn* zaynMem, LevelEditor* editor) {
             }
         }
         
-        // Mark entity as inactive
-        wall->isActive = false;
+        // RemoveEntity queues the render event that takes it out of its batch
+        RemoveAllComponents(&zaynMem->componentsFactory.registry, handle);
+        RemoveEntity(&zaynMem->entityFactory, handle);
         
         printf("Deleted wall entity\n");
     }
@@ -186,25 +155,20 @@ EntityHandle CreateWallEntity(Zayn* zaynMem, vec3 position, vec3 rotation, vec3
     WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
     
     if (wall) {
-        wall->position = position;
-        wall->rotation = rotation;
-        wall->scale = scale;
+        EntityTypeBuffer* walls = &zaynMem->entityFactory.buffers[EntityType_Wall];
+        int32 slot = GetEntityIndexInBuffer(&zaynMem->entityFactory, handle);
+
+        walls->positions[slot] = position;
+        walls->rotations[slot] = rotation;
+        walls->scales[slot] = scale;
         wall->isActive = true;
         
         // Assign default mesh and material if available
         if (zaynMem->meshFactory.meshes.count > 0) {
-            wall->mesh = &zaynMem->meshFactory.meshes[0];
+            walls->meshes[slot] = &zaynMem->meshFactory.meshes[0];
         }
         if (zaynMem->materialFactory.materials.count > 0) {
-            wall->material = &zaynMem->materialFactory.materials[0];
-        }
-        
-        // Add to renderer
-        if (wall->mesh && wall->material) {
-            mat4 transform = TRS(position, rotation, scale);
-            vec3 objectColor = wall->material->objectColor;
-            float materialIndex = 0.0f; // Could be improved to use actual material index
-            AddMeshInstance(wall->mesh, handle, transform, objectColor, materialIndex);
+            walls->materials[slot] = &zaynMem->materialFactory.materials[0];
         }
         
         // Add to game data
@@ -221,31 +185,26 @@ EntityHandle CreateEntityAtPosition(Zayn* zaynMem, EntityType entityType, vec3 p
             WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
             
             if (wall) {
-                wall->position = position;
-                wall->rotation = V3(0, 0, 0);
-                wall->scale = V3(1, 1, 1);
+                EntityTypeBuffer* walls = &zaynMem->entityFactory.buffers[EntityType_Wall];
+                int32 slot = GetEntityIndexInBuffer(&zaynMem->entityFactory, handle);
+
+                walls->positions[slot] = position;
+                walls->rotations[slot] = V3(0, 0, 0);
+                walls->scales[slot] = V3(1, 1, 1);
                 wall->isActive = true;
                 
                 // Assign mesh
                 if (meshIndex >= 0 && meshIndex < zaynMem->meshFactory.meshes.count) {
-                    wall->mesh = &zaynMem->meshFactory.meshes[meshIndex];
+                    walls->meshes[slot] = &zaynMem->meshFactory.meshes[meshIndex];
                 } else if (zaynMem->meshFactory.meshes.count > 0) {
-                    wall->mesh = &zaynMem->meshFactory.meshes[0];
+                    walls->meshes[slot] = &zaynMem->meshFactory.meshes[0];
                 }
                 
                 // Assign material
                 if (materialIndex >= 0 && materialIndex < zaynMem->materialFactory.materials.count) {
-                    wall->material = &zaynMem->materialFactory.materials[materialIndex];
+                    walls->materials[slot] = &zaynMem->materialFactory.materials[materialIndex];
                 } else if (zaynMem->materialFactory.materials.count > 0) {
-                    wall->material = &zaynMem->materialFactory.materials[0];
-                }
-                
-                // Add to renderer
-                if (wall->mesh && wall->material) {
-                    mat4 transform = TRS(position, wall->rotation, wall->scale);
-                    vec3 objectColor = wall->material->objectColor;
-                    float materialIndex = 0.0f; // Could be improved to use actual material index
-                    AddMeshInstance(wall->mesh, handle, transform, objectColor, materialIndex);
+                    walls->materials[slot] = &zaynMem->materialFactory.materials[0];
                 }
                 
                 // Add to game data
@@ -260,22 +219,26 @@ EntityHandle CreateEntityAtPosition(Zayn* zaynMem, EntityType entityType, vec3 p
             LightSourceEntity* light = (LightSourceEntity*)GetEntity(&zaynMem->entityFactory, handle);
             
             if (light) {
-                light->position = position;
+                EntityTypeBuffer* lights = &zaynMem->entityFactory.buffers[EntityType_LightSource];
+                int32 slot = GetEntityIndexInBuffer(&zaynMem->entityFactory, handle);
+
+                lights->positions[slot] = position;
+                lights->scales[slot] = V3(0.2f, 0.2f, 0.2f);  // Small marker, not a real object
                 light->color = zaynMem->levelEditor.lightColorForCreation;  // Use color from UI
                 light->isActive = true;
                 
                 // Optionally assign a small mesh for visual representation in editor
                 if (meshIndex >= 0 && meshIndex < zaynMem->meshFactory.meshes.count) {
-                    light->mesh = &zaynMem->meshFactory.meshes[meshIndex];
+                    lights->meshes[slot] = &zaynMem->meshFactory.meshes[meshIndex];
                 }
                 
                 // Assign material - light sources should NOT use lighting materials
                 // Find first non-lighting material for light source visual representation
-                light->material = nullptr;
+                lights->materials[slot] = nullptr;
                 for (uint32 i = 0; i < zaynMem->materialFactory.materials.count; i++) {
                     Material* mat = &zaynMem->materialFactory.materials[i];
                     if (mat->type != MATERIAL_LIGHTING) {
-                        light->material = mat;
+                        lights->materials[slot] = mat;
                         break;
                     }
                 }
@@ -284,18 +247,10 @@ EntityHandle CreateEntityAtPosition(Zayn* zaynMem, EntityType entityType, vec3 p
                 if (materialIndex >= 0 && materialIndex < zaynMem->materialFactory.materials.count) {
                     Material* selectedMat = &zaynMem->materialFactory.materials[materialIndex];
                     if (selectedMat->type != MATERIAL_LIGHTING) {
-                        light->material = selectedMat;
+                        lights->materials[slot] = selectedMat;
                     }
                 }
                 
-                // Add to renderer for visual debugging if we have both mesh and material
-                if (light->mesh && light->material) {
-                    mat4 transform = TRS(position, V3(0,0,0), V3(0.2f, 0.2f, 0.2f)); // Small scale
-                    vec3 objectColor = light->material->objectColor;
-                    float materialIndex = 0.0f; // Could be improved to use actual material index
-                    AddMeshInstance(light->mesh, handle, transform, objectColor, materialIndex);
-                }
-                
                 // Add to game data
                 PushBack(&zaynMem->gameData.lightSources, handle);
                 
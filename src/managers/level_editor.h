@@ -41,4 +41,7 @@ struct LevelEditor {
     
     // Light creation settings
     vec3 lightColorForCreation;
+
+    // Window visibility
+    bool showMemoryWindow;
 };
\ No newline at end of file
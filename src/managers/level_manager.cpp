@@ -57,27 +57,44 @@ EntityType StringToEntityType(const char* typeName) {
     if (strcmp(typeName, "Player") == 0) return EntityType_Player;
     if (strcmp(typeName, "Floor") == 0) return EntityType_Floor;
     if (strcmp(typeName, "Piano") == 0) return EntityType_Piano;
+    if (strcmp(typeName, "LightSource") == 0) return EntityType_LightSource;
     return EntityType_Player; // Default fallback
 }
 
+const char* EntityTypeToString(EntityType type) {
+    switch (type) {
+        case EntityType_Wall: return "Wall";
+        case EntityType_Player: return "Player";
+        case EntityType_Floor: return "Floor";
+        case EntityType_Piano: return "Piano";
+        case EntityType_LightSource: return "LightSource";
+        default: return "Player";
+    }
+}
+
 void ClearLevel(Zayn* zaynMem) {
     if (!zaynMem) return;
 
-    // Clear mesh instances from renderer
-    for (uint32 i = 0; i < zaynMem->meshFactory.meshes.count; i++) {
-        Mesh* mesh = &zaynMem->meshFactory.meshes[i];
-        ClearMeshInstances(mesh);
-    }
+    // Return material-mesh batches (and their instance arrays) to their pools
+    ClearMaterialMeshBatches(zaynMem);
     
-    // Clear walls from game data
+    // Clear walls and lights from game data
     zaynMem->gameData.walls.count = 0;
+    zaynMem->gameData.lightSources.count = 0;
 
-    // Reset entity factory counts (simple approach)
+    // Destroy every entity so ids and generations are recycled. Removing from
+    // the back of each buffer avoids moving the survivors around.
     for (int i = 0; i < EntityType_Count; i++) {
-        zaynMem->entityFactory.buffers[i].count = 0;
+        EntityTypeBuffer* buffer = &zaynMem->entityFactory.buffers[i];
+        while (buffer->count > 0) {
+            EntityHandle handle = buffer->handles[buffer->count - 1];
+            RemoveAllComponents(&zaynMem->componentsFactory.registry, handle);
+            RemoveEntity(&zaynMem->entityFactory, handle);
+        }
     }
   
     // Reset level data
+    MArrayClear(&zaynMem->levelManager.currentLevel.entities);
     zaynMem->levelManager.currentLevel.entityCount = 0;
     strcpy(zaynMem->levelManager.currentLevel.levelName, "Untitled");
     strcpy(zaynMem->levelManager.currentLevel.version, "1.0");
@@ -115,102 +132,123 @@ bool LoadLevel(Zayn* zaynMem, const char* fileName) {
     
     // Load entities
     if (levelJson.contains("entities") && levelJson["entities"].is_array()) {
-        for (const auto& entityJson : levelJson["entities"]) {
-            if (zaynMem->levelManager.currentLevel.entityCount >= MAX_LEVEL_ENTITIES) {
-                printf("WARNING: Max entities reached, skipping remaining entities\n");
-                break;
+        const json& entitiesJson = levelJson["entities"];
+        EntityFactory* entityFactory = &zaynMem->entityFactory;
+
+        // First pass: count per type so each type is created with one AddEntities call.
+        int32 typeCounts[EntityType_Count] = {};
+        for (const auto& entityJson : entitiesJson) {
+            std::string typeStr = entityJson.value("type", "Wall");
+            typeCounts[StringToEntityType(typeStr.c_str())]++;
+        }
+
+        EntityHandleSpan spans[EntityType_Count] = {};
+        int32 typeCursors[EntityType_Count] = {};
+        for (int32 i = 0; i < EntityType_Count; i++) {
+            if (typeCounts[i] > 0) {
+                spans[i] = AddEntities(entityFactory, (EntityType)i, typeCounts[i]);
             }
-            
+        }
+
+        Mesh* defaultMesh = zaynMem->meshFactory.meshes.count > 0 ? &zaynMem->meshFactory.meshes[0] : NULL;
+        Material* defaultMaterial = zaynMem->materialFactory.materials.count > 0 ? &zaynMem->materialFactory.materials[0] : NULL;
+        if (typeCounts[EntityType_Wall] > 0 && !defaultMesh) {
+            printf("ERROR: No meshes available in mesh factory!\n");
+        }
+        if (typeCounts[EntityType_Wall] > 0 && !defaultMaterial) {
+            printf("ERROR: No materials available in material factory!\n");
+        }
+
+        // Levels usually reuse a handful of materials, so remember the last lookup.
+        std::string lastMaterialName;
+        Material* lastMaterial = NULL;
+
+        // Second pass: fill the reserved slots in file order.
+        for (const auto& entityJson : entitiesJson) {
             std::string typeStr = entityJson.value("type", "Wall");
             EntityType entityType = StringToEntityType(typeStr.c_str());
-            
-            // Create entity using factory
-            EntityHandle handle = AddEntity(&zaynMem->entityFactory, entityType);
-            
-            // Get the created entity
-            if (entityType == EntityType_Wall) {
-                WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
-                if (wall) {
-                    // Set transform
-                    if (entityJson.contains("position") && entityJson["position"].is_array()) {
-                        auto pos = entityJson["position"];
-                        wall->position = V3(pos[0].get<float>(), pos[1].get<float>(), pos[2].get<float>());
-                    }
-                    if (entityJson.contains("rotation") && entityJson["rotation"].is_array()) {
-                        auto rot = entityJson["rotation"];
-                        wall->rotation = V3(rot[0].get<float>(), rot[1].get<float>(), rot[2].get<float>());
-                    }
-                    if (entityJson.contains("scale") && entityJson["scale"].is_array()) {
-                        auto scale = entityJson["scale"];
-                        wall->scale = V3(scale[0].get<float>(), scale[1].get<float>(), scale[2].get<float>());
-                    }
-                    
-                    // Set material if specified
-                    if (entityJson.contains("materialName")) {
-                        std::string matName = entityJson["materialName"];
-                        auto it = zaynMem->materialFactory.materialNamePointerMap.find(matName);
-                        if (it != zaynMem->materialFactory.materialNamePointerMap.end()) {
-                            wall->material = it->second;
-                            printf("Assigned material: %s\n", matName.c_str());
-                        } else {
-                            printf("Material not found: %s\n", matName.c_str());
-                        }
-                    }
-                    
-                    // Set mesh if specified
-                    if (entityJson.contains("meshName")) {
-                        std::string meshName = entityJson["meshName"];
-                        // For now, use a default mesh - you'd need to implement mesh lookup by name
-                        // wall->mesh = FindMeshByName(zaynMem, meshName.c_str());
-                    }
-                    
-                    // Use default mesh if no mesh assigned
-                    if (!wall->mesh) {
-                        // Try to find a default mesh from existing meshes
-                        if (zaynMem->meshFactory.meshes.count > 0) {
-                            wall->mesh = &zaynMem->meshFactory.meshes[0]; // Use first available mesh
-                            printf("Assigned default mesh: %s (mesh count: %d)\n", wall->mesh->name.c_str(), zaynMem->meshFactory.meshes.count);
-                        } else {
-                            printf("ERROR: No meshes available in mesh factory!\n");
-                        }
-                    }
-                    
-                    // Use default material if no material assigned
-                    if (!wall->material) {
-                        if (zaynMem->materialFactory.materials.count > 0) {
-                            wall->material = &zaynMem->materialFactory.materials[0];
-                            printf("Assigned default material: %s\n", wall->material->name.c_str());
-                        } else {
-                            printf("ERROR: No materials available in material factory!\n");
-                        }
-                    }
-                    
-                    // Register with renderer - this is the missing piece!
-                    if (wall->mesh && wall->material) {
-                        mat4 transform = TRS(wall->position, wall->rotation, wall->scale);
-                        vec3 objectColor = wall->material->objectColor;
-                        float materialIndex = 0.0f; // Could be improved to use actual material index
-                        AddMeshInstance(wall->mesh, handle, transform, objectColor, materialIndex);
-                        printf("Added mesh instance at position (%.1f, %.1f, %.1f)\n", 
-                               wall->position.x, wall->position.y, wall->position.z);
-                    } else {
-                        printf("ERROR: Cannot render wall - missing mesh or material\n");
+            EntityTypeBuffer* buffer = &entityFactory->buffers[entityType];
+
+            int32 slot = spans[entityType].firstIndexInBuffer + typeCursors[entityType];
+            typeCursors[entityType]++;
+
+            // Set transform
+            if (entityJson.contains("position") && entityJson["position"].is_array()) {
+                auto& pos = entityJson["position"];
+                buffer->positions[slot] = V3(pos[0].get<float>(), pos[1].get<float>(), pos[2].get<float>());
+            }
+            if (entityJson.contains("rotation") && entityJson["rotation"].is_array()) {
+                auto& rot = entityJson["rotation"];
+                buffer->rotations[slot] = V3(rot[0].get<float>(), rot[1].get<float>(), rot[2].get<float>());
+            }
+            if (entityJson.contains("scale") && entityJson["scale"].is_array()) {
+                auto& scale = entityJson["scale"];
+                buffer->scales[slot] = V3(scale[0].get<float>(), scale[1].get<float>(), scale[2].get<float>());
+            }
+
+            if (entityJson.contains("isStatic")) {
+                buffer->isStatic[slot] = entityJson["isStatic"].get<bool>();
+            }
+
+            // Set material if specified
+            if (entityJson.contains("materialName")) {
+                const std::string& matName = entityJson["materialName"].get_ref<const std::string&>();
+                if (matName != lastMaterialName) {
+                    auto it = zaynMem->materialFactory.materialNamePointerMap.find(matName);
+                    lastMaterial = it != zaynMem->materialFactory.materialNamePointerMap.end() ? it->second : NULL;
+                    lastMaterialName = matName;
+                    if (!lastMaterial) {
+                        printf("Material not found: %s\n", matName.c_str());
                     }
-                    
-                    // Store in game data
-                    PushBack(&zaynMem->gameData.walls, handle);
+                }
+                buffer->materials[slot] = lastMaterial;
+            }
+
+            if (entityType == EntityType_Wall) {
+                // Mesh lookup by name is not implemented yet, so every wall uses the default mesh.
+                if (!buffer->meshes[slot]) {
+                    buffer->meshes[slot] = defaultMesh;
+                }
+                if (!buffer->materials[slot]) {
+                    buffer->materials[slot] = defaultMaterial;
+                }
+
+                // ApplyRenderEvents files the wall into its batch
+                if (!buffer->meshes[slot] || !buffer->materials[slot]) {
+                    printf("ERROR: Cannot render wall - missing mesh or material\n");
+                }
+            }
+            else if (entityType == EntityType_LightSource) {
+                LightSourceEntity* light = (LightSourceEntity*)GetEntityBase(buffer, slot);
+                light->color = V3(1.0f, 1.0f, 1.0f);
+                if (entityJson.contains("color") && entityJson["color"].is_array()) {
+                    auto& color = entityJson["color"];
+                    light->color = V3(color[0].get<float>(), color[1].get<float>(), color[2].get<float>());
                 }
             }
-            
+
             // Store entity info in level data
-            LevelEntity& levelEntity = zaynMem->levelManager.currentLevel.entities[zaynMem->levelManager.currentLevel.entityCount];
+            LevelEntity levelEntity = {};
             strncpy(levelEntity.typeName, typeStr.c_str(), 31);
+            levelEntity.isStatic = buffer->isStatic[slot];
             levelEntity.id = zaynMem->levelManager.currentLevel.entityCount;
-            
+            PushBack(&zaynMem->levelManager.currentLevel.entities, levelEntity);
+
             zaynMem->levelManager.currentLevel.entityCount++;
         }
+
+        // Store in game data
+        if (typeCounts[EntityType_Wall] > 0) {
+            PushBackN(&zaynMem->gameData.walls, spans[EntityType_Wall].handles, (uint32)spans[EntityType_Wall].count);
+        }
+        if (typeCounts[EntityType_LightSource] > 0) {
+            PushBackN(&zaynMem->gameData.lightSources, spans[EntityType_LightSource].handles, (uint32)spans[EntityType_LightSource].count);
+        }
     }
     
+    // Static entities are drawn as dynamic instances until they are baked
+    zaynMem->materialFactory.staticBatchesDirty = true;
+
     zaynMem->levelManager.isLevelLoaded = true;
     printf("Level loaded: %s (%d entities)\n", 
            zaynMem->levelManager.currentLevel.levelName, 
@@ -231,26 +269,35 @@ bool SaveLevel(Zayn* zaynMem, const char* fileName) {
     // Save entities
     levelJson["entities"] = json::array();
     
-    // Save walls
-    for (uint32 i = 0; i < zaynMem->gameData.walls.count; i++) {
-        EntityHandle handle = zaynMem->gameData.walls[i];
-        WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
-        
-        if (wall && wall->isActive) {
+    // Save every live entity of every type straight from the SoA columns
+    EntityFactory* entityFactory = &zaynMem->entityFactory;
+    for (int32 type = 0; type < EntityType_Count; type++) {
+        EntityTypeBuffer* buffer = &entityFactory->buffers[type];
+
+        for (int32 slot = 0; slot < buffer->count; slot++) {
+            Entity* entity = GetEntityBase(buffer, slot);
+            if (!entity->isActive) continue;
+
             json entityJson;
-            entityJson["type"] = "Wall";
-            entityJson["id"] = i;
-            
+            entityJson["type"] = EntityTypeToString((EntityType)type);
+            entityJson["id"] = (int32)levelJson["entities"].size();
+
             // Transform
-            entityJson["position"] = {wall->position.x, wall->position.y, wall->position.z};
-            entityJson["rotation"] = {wall->rotation.x, wall->rotation.y, wall->rotation.z};
-            entityJson["scale"] = {wall->scale.x, wall->scale.y, wall->scale.z};
-            
+            entityJson["position"] = {buffer->positions[slot].x, buffer->positions[slot].y, buffer->positions[slot].z};
+            entityJson["rotation"] = {buffer->rotations[slot].x, buffer->rotations[slot].y, buffer->rotations[slot].z};
+            entityJson["scale"] = {buffer->scales[slot].x, buffer->scales[slot].y, buffer->scales[slot].z};
+            entityJson["isStatic"] = buffer->isStatic[slot];
+
             // Material
-            if (wall->material) {
-                entityJson["materialName"] = wall->material->name;
+            if (buffer->materials[slot]) {
+                entityJson["materialName"] = buffer->materials[slot]->name;
             }
-            
+
+            if (type == EntityType_LightSource) {
+                LightSourceEntity* light = (LightSourceEntity*)entity;
+                entityJson["color"] = {light->color.x, light->color.y, light->color.z};
+            }
+
             // Add to entities array
             levelJson["entities"].push_back(entityJson);
         }
@@ -2,8 +2,6 @@
 // Created by Level Manager
 //
 
-#define MAX_LEVEL_ENTITIES 1000
-
 struct LevelEntity {
     char typeName[32];
     uint32 id;
@@ -34,7 +32,7 @@ struct LevelData {
     char levelName[64];
     char version[16];
     
-    LevelEntity entities[MAX_LEVEL_ENTITIES];
+    MArray<LevelEntity> entities; // heap backed, grows with the level
     uint32 entityCount;
 };
 
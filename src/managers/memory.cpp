@@ -2,3 +2,72 @@
 // Created by Adam Socki on 5/30/25.
 //
 
+#include <nlohmann/json.hpp>
+#include <fstream>
+
+using json = nlohmann::json;
+
+
+json MemoryArenaToJson(MemoryArena *arena) {
+    json result;
+    result["size"] = arena->size;
+    result["peak"] = arena->peakSize;
+    result["committed"] = arena->committed;
+    result["capacity"] = arena->capacity;
+    return result;
+}
+
+json MemoryAllocatorStatsToJson(MemoryAllocatorStats *stats) {
+    json result;
+    result["current"] = stats->bytesInUse;
+    result["peak"] = stats->peakBytesInUse;
+    result["live"] = stats->liveAllocations;
+    result["allocations"] = stats->totalAllocations;
+    result["frees"] = stats->totalFrees;
+    return result;
+}
+
+json MemoryStatsToJson(Zayn *zaynMem) {
+    json result;
+
+    result["arenas"]["frame"] = MemoryArenaToJson(&zaynMem->frameMemory);
+    result["arenas"]["permanent"] = MemoryArenaToJson(&zaynMem->permanentMemory);
+
+    uint32 threadCount = zaynMem->threadMemory.registeredThreadCount.load();
+    for (uint32 i = 0; i < threadCount; i++) {
+        result["arenas"]["thread" + std::to_string(i)] = MemoryArenaToJson(&zaynMem->threadMemory.threadArenas[i].frameArena);
+    }
+
+    result["allocators"]["general"] = MemoryAllocatorStatsToJson(&zaynMem->generalMemory.stats);
+    result["allocators"]["generalLarge"] = MemoryAllocatorStatsToJson(&zaynMem->generalMemory.largeStats);
+    result["allocators"]["batchPool"] = MemoryAllocatorStatsToJson(&zaynMem->materialFactory.batchPool.stats);
+
+    EntityFactory *entityFactory = &zaynMem->entityFactory;
+    result["entities"]["ids"]["used"] = entityFactory->nextID;
+    result["entities"]["ids"]["capacity"] = entityFactory->entityCapacity;
+    result["entities"]["ids"]["free"] = entityFactory->freeList.count;
+    for (int32 i = 0; i < EntityType_Count; i++) {
+        EntityTypeBuffer *buffer = &entityFactory->buffers[i];
+        const char *typeName = entityFactory->entityTypeInfoForBuffer[i].typeName;
+        result["entities"]["buffers"][typeName]["count"] = buffer->count;
+        result["entities"]["buffers"][typeName]["capacity"] = buffer->capacity;
+    }
+
+    for (int32 i = 0; i < MemoryTag_Count; i++) {
+        result["tags"][MemoryTagNames[i]]["cpu"] = MemoryAllocatorStatsToJson(&memoryTracker.cpu[i]);
+        result["tags"][MemoryTagNames[i]]["gpu"] = MemoryAllocatorStatsToJson(&memoryTracker.gpu[i]);
+    }
+
+    return result;
+}
+
+void DumpMemoryStats(Zayn *zaynMem, const std::string &path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open memory stats file: " << path << std::endl;
+        return;
+    }
+
+    file << MemoryStatsToJson(zaynMem).dump(2);
+    std::cout << "Memory stats written to " << path << std::endl;
+}
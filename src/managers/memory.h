@@ -1,11 +1,21 @@
 
 
-#define Bytes(n) (n)
+#define Bytes(n) ((uint64)(n))
 #define Kilobytes(n) (1024 * Bytes(n))
 #define Megabytes(n) (1024 * Kilobytes(n))
 #define Gigabytes(n) (1024 * Megabytes(n))
 #include <cassert>
 #include <string.h>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
 // @TODO:
 // clearer name for size.
@@ -37,9 +47,16 @@ inline void DeallocateMem(MAllocator *allocator, void *data) {
 }
 
 
+#define MEMORY_ARENA_DEFAULT_ALIGNMENT 16
+#define MEMORY_ARENA_COMMIT_GRANULARITY Kilobytes(64)
+
 struct MemoryArena : MAllocator {
-    uint32 capacity;
-    uint32 size; // in bytes
+    uint64 capacity; // reserved bytes for virtual arenas
+    uint64 size; // in bytes
+    uint64 committed; // bytes backed by pages, == capacity for malloc arenas
+    bool isVirtual;
+    int32 tempCount; // open TempMemory markers
+    uint64 peakSize; // high-water mark of size since the arena was created
     void *ptr;
 };
 
@@ -51,34 +68,198 @@ void AllocateMemoryArena(MemoryArena *arena, uint64 capacity) {
     arena->allocate = (AllocateFunc *)allocate;
     arena->deallocate = NULL;
 
-    // size_t align = 8;
-    // arena->used = (arena->used + (align - 1)) & ~(align - 1);
-
     arena->capacity = capacity;
+    arena->committed = capacity;
+    arena->isVirtual = false;
     arena->size = 0;
+    arena->peakSize = 0;
     arena->ptr = malloc(capacity);
     memset(arena->ptr, 0, capacity);
 }
 
-void *PushSizeMemoryArena(MemoryArena *arena, uint64 size) {
-    void *result = (uint8 *)arena->ptr + arena->size;
-    arena->size += size;
+// Reserves address space only; pages are committed in MEMORY_ARENA_COMMIT_GRANULARITY
+// steps as the arena grows, so unused capacity costs neither startup time nor RSS.
+// Fresh pages come back zeroed from the OS.
+void ReserveMemoryArena(MemoryArena *arena, uint64 reserveSize) {
+    void *(*allocate)(MemoryArena *, uint64) = &PushSizeMemoryArena;
+    arena->allocate = (AllocateFunc *)allocate;
+    arena->deallocate = NULL;
 
-    assert(arena->size < arena->capacity);
+    reserveSize = (reserveSize + MEMORY_ARENA_COMMIT_GRANULARITY - 1) & ~(MEMORY_ARENA_COMMIT_GRANULARITY - 1);
 
-    return result;
+#ifdef WIN32
+    arena->ptr = VirtualAlloc(NULL, reserveSize, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    arena->ptr = mmap(NULL, reserveSize, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    if (arena->ptr == MAP_FAILED) {
+        arena->ptr = NULL;
+    }
+#endif
+    assert(arena->ptr != NULL);
+
+    arena->capacity = reserveSize;
+    arena->committed = 0;
+    arena->isVirtual = true;
+    arena->size = 0;
+    arena->peakSize = 0;
+}
+
+void ReleaseMemoryArena(MemoryArena *arena) {
+    if (arena->ptr == NULL) { return; }
+
+    if (arena->isVirtual) {
+#ifdef WIN32
+        VirtualFree(arena->ptr, 0, MEM_RELEASE);
+#else
+        munmap(arena->ptr, arena->capacity);
+#endif
+    }
+    else {
+        free(arena->ptr);
+    }
+
+    arena->ptr = NULL;
+    arena->capacity = 0;
+    arena->committed = 0;
+    arena->size = 0;
+}
+
+bool CommitMemoryArena(MemoryArena *arena, uint64 requiredSize) {
+    if (requiredSize <= arena->committed) { return true; }
+    if (!arena->isVirtual || requiredSize > arena->capacity) { return false; }
+
+    uint64 newCommitted = (requiredSize + MEMORY_ARENA_COMMIT_GRANULARITY - 1) & ~(MEMORY_ARENA_COMMIT_GRANULARITY - 1);
+    if (newCommitted > arena->capacity) {
+        newCommitted = arena->capacity;
+    }
+
+    uint8 *commitStart = (uint8 *)arena->ptr + arena->committed;
+    uint64 commitSize = newCommitted - arena->committed;
+
+#ifdef WIN32
+    if (VirtualAlloc(commitStart, commitSize, MEM_COMMIT, PAGE_READWRITE) == NULL) { return false; }
+#else
+    if (mprotect(commitStart, commitSize, PROT_READ | PROT_WRITE) != 0) { return false; }
+#endif
+
+    arena->committed = newCommitted;
+    return true;
+}
+
+// alignment must be a power of two.
+void *PushSizeMemoryArenaAligned(MemoryArena *arena, uint64 size, uint64 alignment) {
+    assert((alignment & (alignment - 1)) == 0);
+
+    uintptr_t base = (uintptr_t)arena->ptr;
+    uintptr_t alignedAddress = (base + arena->size + (alignment - 1)) & ~((uintptr_t)alignment - 1);
+    uint64 alignedOffset = alignedAddress - base;
+    uint64 newSize = alignedOffset + size;
+
+    if (!CommitMemoryArena(arena, newSize)) {
+        assert(!"MemoryArena out of memory");
+        return NULL;
+    }
+
+    arena->size = newSize;
+    if (newSize > arena->peakSize) {
+        arena->peakSize = newSize;
+    }
+    return (void *)alignedAddress;
+}
+
+void *PushSizeMemoryArena(MemoryArena *arena, uint64 size) {
+    return PushSizeMemoryArenaAligned(arena, size, MEMORY_ARENA_DEFAULT_ALIGNMENT);
 }
 
 void ClearMemoryArena(MemoryArena *arena) {
+    assert(arena->tempCount == 0);
     arena->size = 0;
 }
 
+// Savepoint on an arena: everything pushed between BeginTempMemory and
+// EndTempMemory is released in O(1) when the marker is ended. Markers nest.
+struct TempMemory {
+    MemoryArena *arena;
+    uint64 size;
+};
+
+inline TempMemory BeginTempMemory(MemoryArena *arena) {
+    TempMemory result = {};
+    result.arena = arena;
+    result.size = arena->size;
+
+    arena->tempCount++;
+    return result;
+}
+
+inline void EndTempMemory(TempMemory temp) {
+    MemoryArena *arena = temp.arena;
+    assert(arena->size >= temp.size);
+    assert(arena->tempCount > 0);
+
+    arena->size = temp.size;
+    arena->tempCount--;
+}
+
 // Using a macro here so we can cast and calculate the size.
 #define PushSize(arena, count) PushSizeMemoryArena(arena, count)
-#define PushArray(arena, type, count) (type *)PushSizeMemoryArena(arena, sizeof(type) * count)
+#define PushSizeAligned(arena, count, alignment) PushSizeMemoryArenaAligned(arena, count, alignment)
+#define PushArray(arena, type, count) (type *)PushSizeMemoryArena(arena, sizeof(type) * (count))
+#define PushArrayAligned(arena, type, count, alignment) (type *)PushSizeMemoryArenaAligned(arena, sizeof(type) * (count), alignment)
 
 // @TODO: PushArray is a better name
 
+
+// Bump allocator that many threads can push into at once. The block is
+// committed up front and handed out with a CAS on size, so there is no lock.
+struct AtomicMemoryArena : MAllocator {
+    std::atomic<uint64> size;
+    uint64 capacity;
+    void *ptr;
+};
+
+void *PushSizeAtomicArena(AtomicMemoryArena *arena, uint64 size);
+
+void InitAtomicMemoryArena(AtomicMemoryArena *arena, void *memory, uint64 capacity) {
+    void *(*allocate)(AtomicMemoryArena *, uint64) = &PushSizeAtomicArena;
+    arena->allocate = (AllocateFunc *)allocate;
+    arena->deallocate = NULL;
+
+    arena->ptr = memory;
+    arena->capacity = capacity;
+    arena->size.store(0, std::memory_order_relaxed);
+}
+
+void *PushSizeAtomicArenaAligned(AtomicMemoryArena *arena, uint64 size, uint64 alignment) {
+    assert((alignment & (alignment - 1)) == 0);
+
+    uintptr_t base = (uintptr_t)arena->ptr;
+    uint64 oldSize = arena->size.load(std::memory_order_relaxed);
+    uint64 alignedOffset;
+    uint64 newSize;
+
+    do {
+        alignedOffset = ((base + oldSize + (alignment - 1)) & ~((uintptr_t)alignment - 1)) - base;
+        newSize = alignedOffset + size;
+
+        if (newSize > arena->capacity) {
+            assert(!"AtomicMemoryArena out of memory");
+            return NULL;
+        }
+    } while (!arena->size.compare_exchange_weak(oldSize, newSize, std::memory_order_relaxed));
+
+    return (uint8 *)arena->ptr + alignedOffset;
+}
+
+void *PushSizeAtomicArena(AtomicMemoryArena *arena, uint64 size) {
+    return PushSizeAtomicArenaAligned(arena, size, MEMORY_ARENA_DEFAULT_ALIGNMENT);
+}
+
+// Only call when no thread is pushing (e.g. at the start of a frame).
+void ClearAtomicMemoryArena(AtomicMemoryArena *arena) {
+    arena->size.store(0, std::memory_order_relaxed);
+}
+
 inline void *AllocCleared(int32 size) {
     void *d = malloc(size);
     memset(d, 0, size);
@@ -86,7 +267,251 @@ inline void *AllocCleared(int32 size) {
 }
 
 
+struct MemoryAllocatorStats {
+    uint64 liveAllocations;
+    uint64 totalAllocations;
+    uint64 totalFrees;
+    uint64 bytesInUse;
+    uint64 peakBytesInUse;
+    uint64 bytesReserved; // taken from the backing store, never given back
+};
+
+inline void RecordAllocation(MemoryAllocatorStats *stats, uint64 size) {
+    stats->liveAllocations++;
+    stats->totalAllocations++;
+    stats->bytesInUse += size;
+    if (stats->bytesInUse > stats->peakBytesInUse) {
+        stats->peakBytesInUse = stats->bytesInUse;
+    }
+}
+
+inline void RecordFree(MemoryAllocatorStats *stats, uint64 size) {
+    assert(stats->liveAllocations > 0 && stats->bytesInUse >= size);
+    stats->liveAllocations--;
+    stats->totalFrees++;
+    stats->bytesInUse -= size;
+}
+
+
+// Per-subsystem accounting. Anything that knows which subsystem it is
+// allocating for (DynamicArray chunks, Vulkan buffers and images) reports
+// here so the editor can show where the bytes went. Main thread only.
+enum MemoryTag {
+    MemoryTag_Untagged,
+    MemoryTag_Mesh,
+    MemoryTag_Texture,
+    MemoryTag_Material,
+    MemoryTag_Entity,
+    MemoryTag_Level,
+    MemoryTag_Input,
+    MemoryTag_Render,
+
+    MemoryTag_Count
+};
+
+const char *MemoryTagNames[MemoryTag_Count] = {
+    "untagged",
+    "mesh",
+    "texture",
+    "material",
+    "entity",
+    "level",
+    "input",
+    "render",
+};
+
+struct MemoryTracker {
+    MemoryAllocatorStats cpu[MemoryTag_Count];
+    MemoryAllocatorStats gpu[MemoryTag_Count];
+};
+
+MemoryTracker memoryTracker = {};
+
+inline void TrackAllocation(MemoryTag tag, uint64 size) {
+    RecordAllocation(&memoryTracker.cpu[tag], size);
+}
+
+inline void TrackFree(MemoryTag tag, uint64 size) {
+    RecordFree(&memoryTracker.cpu[tag], size);
+}
+
+inline void TrackDeviceAllocation(MemoryTag tag, uint64 size) {
+    RecordAllocation(&memoryTracker.gpu[tag], size);
+}
+
+inline void TrackDeviceFree(MemoryTag tag, uint64 size) {
+    RecordFree(&memoryTracker.gpu[tag], size);
+}
+
+
+// Fixed-size block pool. Blocks are carved from a backing arena a page at a
+// time and recycled through an intrusive free list, so repeated create/destroy
+// cycles reuse the same memory without fragmenting the arena.
+struct PoolFreeBlock {
+    PoolFreeBlock *next;
+};
+
+struct MemoryPool : MAllocator {
+    MemoryArena *backingArena;
+    uint64 blockSize;
+    uint32 blocksPerPage;
+
+    PoolFreeBlock *freeList;
+    MemoryAllocatorStats stats;
+};
+
+void *PoolAllocate(MemoryPool *pool, uint64 size);
+void PoolDeallocate(MemoryPool *pool, void *data);
+
+void InitMemoryPool(MemoryPool *pool, MemoryArena *backingArena, uint64 blockSize, uint32 blocksPerPage) {
+    void *(*allocate)(MemoryPool *, uint64) = &PoolAllocate;
+    void (*deallocate)(MemoryPool *, void *) = &PoolDeallocate;
+    pool->allocate = (AllocateFunc *)allocate;
+    pool->deallocate = (DeallocateFunc *)deallocate;
+
+    if (blockSize < sizeof(PoolFreeBlock)) {
+        blockSize = sizeof(PoolFreeBlock);
+    }
+    blockSize = (blockSize + MEMORY_ARENA_DEFAULT_ALIGNMENT - 1) & ~((uint64)MEMORY_ARENA_DEFAULT_ALIGNMENT - 1);
+
+    pool->backingArena = backingArena;
+    pool->blockSize = blockSize;
+    pool->blocksPerPage = blocksPerPage > 0 ? blocksPerPage : 1;
+    pool->freeList = NULL;
+    pool->stats = {};
+}
+
+void *PoolAllocate(MemoryPool *pool, uint64 size) {
+    assert(size <= pool->blockSize);
+
+    if (pool->freeList == NULL) {
+        uint64 pageSize = pool->blockSize * pool->blocksPerPage;
+        uint8 *page = (uint8 *)PushSizeMemoryArena(pool->backingArena, pageSize);
+        if (page == NULL) { return NULL; }
+
+        // Thread the new blocks so the lowest address is handed out first.
+        for (int64 i = pool->blocksPerPage - 1; i >= 0; i--) {
+            PoolFreeBlock *block = (PoolFreeBlock *)(page + i * pool->blockSize);
+            block->next = pool->freeList;
+            pool->freeList = block;
+        }
+        pool->stats.bytesReserved += pageSize;
+    }
+
+    PoolFreeBlock *block = pool->freeList;
+    pool->freeList = block->next;
+
+    RecordAllocation(&pool->stats, pool->blockSize);
+    return block;
+}
+
+void PoolDeallocate(MemoryPool *pool, void *data) {
+    if (data == NULL) { return; }
+
+    PoolFreeBlock *block = (PoolFreeBlock *)data;
+    block->next = pool->freeList;
+    pool->freeList = block;
+
+    RecordFree(&pool->stats, pool->blockSize);
+}
+
+
+// General-purpose allocator built from power-of-two MemoryPools (16 B .. 1 MB).
+// Each allocation carries a 16-byte header naming its size class so deallocate
+// can route it back; anything larger than the biggest class goes to malloc.
+#define SIZE_CLASS_MIN_SHIFT 4
+#define SIZE_CLASS_COUNT 17
+#define SIZE_CLASS_LARGE 0xFFFFFFFF
+#define SIZE_CLASS_PAGE_SIZE Kilobytes(256)
+
+struct SizeClassHeader {
+    uint64 size;
+    uint32 sizeClass;
+    uint32 pad;
+};
+
+struct SizeClassAllocator : MAllocator {
+    MemoryPool pools[SIZE_CLASS_COUNT];
+
+    MemoryAllocatorStats stats; // requested bytes, including large allocations
+    MemoryAllocatorStats largeStats;
+};
+
+void *SizeClassAllocate(SizeClassAllocator *allocator, uint64 size);
+void SizeClassDeallocate(SizeClassAllocator *allocator, void *data);
+
+void InitSizeClassAllocator(SizeClassAllocator *allocator, MemoryArena *backingArena) {
+    void *(*allocate)(SizeClassAllocator *, uint64) = &SizeClassAllocate;
+    void (*deallocate)(SizeClassAllocator *, void *) = &SizeClassDeallocate;
+    allocator->allocate = (AllocateFunc *)allocate;
+    allocator->deallocate = (DeallocateFunc *)deallocate;
+
+    for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++) {
+        uint64 blockSize = Bytes(1) << (SIZE_CLASS_MIN_SHIFT + i);
+        uint64 blocksPerPage = SIZE_CLASS_PAGE_SIZE / blockSize;
+        InitMemoryPool(&allocator->pools[i], backingArena, blockSize, (uint32)blocksPerPage);
+    }
+
+    allocator->stats = {};
+    allocator->largeStats = {};
+}
+
+inline uint32 GetSizeClass(uint64 totalSize) {
+    for (uint32 i = 0; i < SIZE_CLASS_COUNT; i++) {
+        if ((Bytes(1) << (SIZE_CLASS_MIN_SHIFT + i)) >= totalSize) {
+            return i;
+        }
+    }
+    return SIZE_CLASS_LARGE;
+}
+
+void *SizeClassAllocate(SizeClassAllocator *allocator, uint64 size) {
+    uint64 totalSize = size + sizeof(SizeClassHeader);
+    uint32 sizeClass = GetSizeClass(totalSize);
 
+    SizeClassHeader *header = NULL;
+    if (sizeClass == SIZE_CLASS_LARGE) {
+        header = (SizeClassHeader *)malloc(totalSize);
+        if (header == NULL) { return NULL; }
+        RecordAllocation(&allocator->largeStats, totalSize);
+    }
+    else {
+        header = (SizeClassHeader *)PoolAllocate(&allocator->pools[sizeClass], totalSize);
+        if (header == NULL) { return NULL; }
+    }
+
+    header->size = size;
+    header->sizeClass = sizeClass;
+
+    RecordAllocation(&allocator->stats, size);
+    return header + 1;
+}
+
+void SizeClassDeallocate(SizeClassAllocator *allocator, void *data) {
+    if (data == NULL) { return; }
+
+    SizeClassHeader *header = (SizeClassHeader *)data - 1;
+    RecordFree(&allocator->stats, header->size);
+
+    if (header->sizeClass == SIZE_CLASS_LARGE) {
+        RecordFree(&allocator->largeStats, header->size + sizeof(SizeClassHeader));
+        free(header);
+    }
+    else {
+        assert(header->sizeClass < SIZE_CLASS_COUNT);
+        PoolDeallocate(&allocator->pools[header->sizeClass], header);
+    }
+}
+
+
+
+
+// Contiguous growable array. Storage is 64-byte aligned so SoA streams can be
+// walked with aligned SIMD loads, and it grows geometrically through its
+// MAllocator (or the heap when allocator is NULL). Elements that are trivially
+// copyable are relocated with memcpy; anything else is move-constructed.
+#define MARRAY_ALIGNMENT 64
+#define MARRAY_MIN_CAPACITY 8
 
 template <typename T>
 struct MArray {
@@ -94,63 +519,190 @@ struct MArray {
     uint32 capacity;
 
     T *data;
+    MAllocator *allocator;
+    MemoryTag tag;
 
     // Compiler complains if this isn't a non-static member function!
     inline T& operator[](const int index) const {
+        assert(index >= 0 && (uint32)index < count);
         return data[index];
     }
+
+    inline T *begin() const { return data; }
+    inline T *end() const { return data + count; }
 };
 
+// The block actually returned by the allocator is stashed just before the
+// aligned data so it can be handed back on free.
+inline void *MArrayAllocateAligned(MAllocator *allocator, uint64 size) {
+    uint64 totalSize = size + MARRAY_ALIGNMENT + sizeof(void *);
+    void *block = allocator ? AllocateMem(allocator, totalSize) : malloc(totalSize);
+    assert(block != NULL);
+
+    uintptr_t aligned = ((uintptr_t)block + sizeof(void *) + (MARRAY_ALIGNMENT - 1)) & ~((uintptr_t)MARRAY_ALIGNMENT - 1);
+    ((void **)aligned)[-1] = block;
+    return (void *)aligned;
+}
+
+inline void MArrayFreeAligned(MAllocator *allocator, void *data) {
+    if (data == NULL) { return; }
+
+    void *block = ((void **)data)[-1];
+    if (allocator) {
+        DeallocateMem(allocator, block);
+    }
+    else {
+        free(block);
+    }
+}
+
+template <typename T>
+void Reserve(MArray<T> *array, uint32 capacity) {
+    if (capacity <= array->capacity) { return; }
+
+    T *newData = (T *)MArrayAllocateAligned(array->allocator, sizeof(T) * capacity);
+
+    if (array->data) {
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            memcpy(newData, array->data, sizeof(T) * array->count);
+        }
+        else {
+            for (uint32 i = 0; i < array->count; i++) {
+                new (&newData[i]) T(std::move(array->data[i]));
+                array->data[i].~T();
+            }
+        }
+
+        MArrayFreeAligned(array->allocator, array->data);
+        TrackFree(array->tag, sizeof(T) * array->capacity);
+    }
+
+    TrackAllocation(array->tag, sizeof(T) * capacity);
+    array->data = newData;
+    array->capacity = capacity;
+}
+
+// Grows to at least minCapacity, doubling so PushBack stays amortised O(1).
+template <typename T>
+inline void MArrayGrow(MArray<T> *array, uint32 minCapacity) {
+    if (minCapacity <= array->capacity) { return; }
+
+    uint32 newCapacity = array->capacity ? array->capacity * 2 : MARRAY_MIN_CAPACITY;
+    if (newCapacity < minCapacity) {
+        newCapacity = minCapacity;
+    }
+
+    Reserve(array, newCapacity);
+}
 
 // Default MakeArray uses the heap.
 template <typename T>
 MArray<T> MakeMArray(uint32 capacity) {
     MArray<T> array = {};
-    array.count = 0;
-    array.capacity = capacity;
+    Reserve(&array, capacity);
+    return array;
+}
 
-    if (capacity > 0) {
-        array.data = (T *)malloc(sizeof(T) * capacity);
+template <typename T>
+MArray<T> MakeMArray(MAllocator *allocator, uint32 capacity, MemoryTag tag = MemoryTag_Untagged) {
+    MArray<T> array = {};
+    array.allocator = allocator;
+    array.tag = tag;
+    Reserve(&array, capacity);
+    return array;
+}
+
+template <typename T>
+void DeallocateMArray(MArray<T> *array) {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (uint32 i = 0; i < array->count; i++) {
+            array->data[i].~T();
+        }
     }
 
-    return array;
+    if (array->data) {
+        MArrayFreeAligned(array->allocator, array->data);
+        TrackFree(array->tag, sizeof(T) * array->capacity);
+    }
+    array->data = NULL;
+    array->count = 0;
+    array->capacity = 0;
 }
 
 template <typename T>
-MArray<T> MakeMArray(MAllocator *allocator, uint32 capacity) {
-    MArray<T> array = {};
-    array.count = 0;
-    array.capacity = capacity;
+uint32 PushBack(MArray<T> *array, T element) {
+    MArrayGrow(array, array->count + 1);
 
-    if (capacity > 0) {
-        array.data = (T *)allocator->allocate(allocator, sizeof(T) * capacity);
+    uint32 index = array->count;
+    new (&array->data[index]) T(std::move(element));
+    array->count++;
+    return index;
+}
+
+// Appends elementCount elements with a single grow and, for trivially
+// copyable types, a single memcpy. Returns the index of the first one.
+template <typename T>
+uint32 PushBackN(MArray<T> *array, const T *elements, uint32 elementCount) {
+    MArrayGrow(array, array->count + elementCount);
+
+    uint32 firstIndex = array->count;
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        memcpy(array->data + firstIndex, elements, sizeof(T) * elementCount);
+    }
+    else {
+        for (uint32 i = 0; i < elementCount; i++) {
+            new (&array->data[firstIndex + i]) T(elements[i]);
+        }
     }
 
-    return array;
+    array->count += elementCount;
+    return firstIndex;
 }
 
+// New elements are value-initialised (zeroed for trivial types).
 template <typename T>
-void PushBack(MArray<T> *array, T element) {
-    if (array->count < array->capacity) {
-        array->data[array->count] = element;
-        array->count++;
+void Resize(MArray<T> *array, uint32 newCount) {
+    if (newCount > array->count) {
+        MArrayGrow(array, newCount);
+
+        if constexpr (std::is_trivially_default_constructible<T>::value) {
+            memset(array->data + array->count, 0, sizeof(T) * (newCount - array->count));
+        }
+        else {
+            for (uint32 i = array->count; i < newCount; i++) {
+                new (&array->data[i]) T();
+            }
+        }
     }
+    else if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (uint32 i = newCount; i < array->count; i++) {
+            array->data[i].~T();
+        }
+    }
+
+    array->count = newCount;
+}
+
+template <typename T>
+inline void MArrayClear(MArray<T> *array) {
+    Resize(array, 0);
 }
 
 template <typename T>
 inline void RemoveAtIndexBySwap(MArray<T> *array, uint32 index) {
-    ASSERT(index < array->count);
+    assert(index < array->count);
 
     if (index != array->count - 1) {
-        array->data[index] = array->data[array->count - 1];
+        array->data[index] = std::move(array->data[array->count - 1]);
     }
 
+    array->data[array->count - 1].~T();
     array->count--;
 }
 
 template <typename T>
 inline T Last(MArray<T> *array) {
-    ASSERT(array->count > 0);
+    assert(array->count > 0);
 
     T result = array->data[array->count - 1];
     return result;
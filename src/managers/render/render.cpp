@@ -1,7 +1,6 @@
 
 
 #if VULKAN
-#define MAX_FRAMES_IN_FLIGHT 2
 #include "render_vulkan_init.cpp"
 #include "render_vulkan_core.cpp"
 
@@ -27,6 +26,8 @@ void InitRender(Zayn* zaynMem)
 
 	#ifdef VULKAN
 	InitRender_Vulkan(&zaynMem->renderer, &zaynMem->windowManager);
+	InitBatchStorage(zaynMem);
+	RegisterRenderSystems(zaynMem);
 	#elif  OPENGL
 	InitRender_OpenGL();
 	#elif  METAL
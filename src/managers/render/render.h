@@ -2,6 +2,7 @@
 
 
 #if VULKAN
+#define MAX_FRAMES_IN_FLIGHT 2
 #include "render_vulkan.h"
 #endif
 
@@ -4,11 +4,34 @@
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 #include <optional>
+#include <unordered_map>
+
+// What the shaders read per instance: the top three rows of an affine model
+// matrix, 48 bytes. Batches keep these in the shared storage buffers of set 1,
+// read through the visible instance indices; the layout matches
+// InstanceTransform in the vertex shaders under std430.
+struct InstanceTransform {
+	glm::vec4 rows[3];
+};
+
+inline InstanceTransform MakeInstanceTransform(mat4 m) {
+	InstanceTransform result;
+	for (uint32_t row = 0; row < 3; row++) {
+		result.rows[row] = glm::vec4(m.data[row], m.data[4 + row], m.data[8 + row], m.data[12 + row]);
+	}
+	return result;
+}
 
-struct InstancedData {
-	mat4 modelMatrix;
-	glm::vec3 objectColor;  // Per-instance color for lighting materials
-	float materialIndex;    // Index to identify which material this instance uses
+// Chosen per mesh. Both formats feed the same shader inputs: the compact
+// attributes are expanded to floats by the vertex fetch, so one set of shaders
+// serves both. The pipelines differ in vertex input state and in the
+// COMPACT_NORMALS specialization constant, which turns on the vertex
+// shaders' octahedral normal decode.
+enum VertexFormat {
+    VertexFormat_Float,
+    VertexFormat_Compact,
+
+    VertexFormat_Count,
 };
 
 struct Vertex {
@@ -17,8 +40,6 @@ struct Vertex {
         glm::vec2 texCoord;
         glm::vec3 normal;
 
-        mat4 modelMatrix;
-
         static VkVertexInputBindingDescription getBindingDescription() {
             VkVertexInputBindingDescription bindingDescription{};
             bindingDescription.binding = 0;
@@ -28,19 +49,6 @@ struct Vertex {
             return bindingDescription;
         }
 
-        static std::array<VkVertexInputBindingDescription, 2> getBindingDescriptions_instanced() {
-            std::array<VkVertexInputBindingDescription, 2> bindingDescriptions{};
-            bindingDescriptions[0].binding = 0;
-            bindingDescriptions[0].stride = sizeof(Vertex);
-            bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-            bindingDescriptions[1].binding = 1;
-            bindingDescriptions[1].stride = sizeof(InstancedData);
-            bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
-
-            return bindingDescriptions;
-        }
-
         static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions() {
             std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
 
@@ -67,70 +75,57 @@ struct Vertex {
             return attributeDescriptions;
         }
 
-        static std::array<VkVertexInputAttributeDescription, 10> getAttributeDescriptions_instanced() {
-            std::array<VkVertexInputAttributeDescription, 10> attributeDescriptions{};
+        bool operator==(const Vertex &other) const {
+            return pos == other.pos && color == other.color && texCoord == other.texCoord && normal == other.normal;
+        }
+    };
+
+// 20-byte vertex: half-float position (w is padding), unorm16 UVs, unorm8 colour
+// and an octahedral normal in two snorm16s. Built from Vertex by CompactVertices.
+struct VertexCompact {
+        uint32_t posXY;       // half2
+        uint32_t posZW;       // half2
+        uint32_t color;       // unorm8x4
+        uint32_t texCoord;    // unorm16x2
+        uint32_t normal;      // snorm16x2, octahedral
+
+        static VkVertexInputBindingDescription getBindingDescription() {
+            VkVertexInputBindingDescription bindingDescription{};
+            bindingDescription.binding = 0;
+            bindingDescription.stride = sizeof(VertexCompact);
+            bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            return bindingDescription;
+        }
+
+        static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions() {
+            std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
 
-            // Vertex attributes (binding 0)
             attributeDescriptions[0].binding = 0;
             attributeDescriptions[0].location = 0;
-            attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[0].offset = offsetof(Vertex, pos);
+            attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_SFLOAT;
+            attributeDescriptions[0].offset = offsetof(VertexCompact, posXY);
 
             attributeDescriptions[1].binding = 0;
             attributeDescriptions[1].location = 1;
-            attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[1].offset = offsetof(Vertex, color);
+            attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+            attributeDescriptions[1].offset = offsetof(VertexCompact, color);
 
             attributeDescriptions[2].binding = 0;
             attributeDescriptions[2].location = 2;
-            attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-            attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
+            attributeDescriptions[2].format = VK_FORMAT_R16G16_UNORM;
+            attributeDescriptions[2].offset = offsetof(VertexCompact, texCoord);
 
+            // Arrives as (octX, octY, 0); the vertex shaders decode it when COMPACT_NORMALS is set.
             attributeDescriptions[3].binding = 0;
             attributeDescriptions[3].location = 3;
-            attributeDescriptions[3].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[3].offset = offsetof(Vertex, normal);
-
-            // Instance attributes (binding 1) - Model Matrix (4x4)
-            attributeDescriptions[4].binding = 1;
-            attributeDescriptions[4].location = 4;
-            attributeDescriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-            attributeDescriptions[4].offset = offsetof(InstancedData, modelMatrix) + sizeof(glm::vec4) * 0;
-
-            attributeDescriptions[5].binding = 1;
-            attributeDescriptions[5].location = 5;
-            attributeDescriptions[5].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-            attributeDescriptions[5].offset = offsetof(InstancedData, modelMatrix) + sizeof(glm::vec4) * 1;
-
-            attributeDescriptions[6].binding = 1;
-            attributeDescriptions[6].location = 6;
-            attributeDescriptions[6].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-            attributeDescriptions[6].offset = offsetof(InstancedData, modelMatrix) + sizeof(glm::vec4) * 2;
-
-            attributeDescriptions[7].binding = 1;
-            attributeDescriptions[7].location = 7;
-            attributeDescriptions[7].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-            attributeDescriptions[7].offset = offsetof(InstancedData, modelMatrix) + sizeof(glm::vec4) * 3;
-
-            // Instance attributes - Object Color
-            attributeDescriptions[8].binding = 1;
-            attributeDescriptions[8].location = 8;
-            attributeDescriptions[8].format = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[8].offset = offsetof(InstancedData, objectColor);
-
-            // Instance attributes - Material Index
-            attributeDescriptions[9].binding = 1;
-            attributeDescriptions[9].location = 9;
-            attributeDescriptions[9].format = VK_FORMAT_R32_SFLOAT;
-            attributeDescriptions[9].offset = offsetof(InstancedData, materialIndex);
+            attributeDescriptions[3].format = VK_FORMAT_R16G16_SNORM;
+            attributeDescriptions[3].offset = offsetof(VertexCompact, normal);
 
             return attributeDescriptions;
         }
-
-        bool operator==(const Vertex &other) const {
-            return pos == other.pos && color == other.color && texCoord == other.texCoord;
-        }
     };
+
 namespace std {
     // Hash function for glm::vec2
     template<>
@@ -192,6 +187,31 @@ struct ModelPushConstant
 	mat4 model_1;
 };
 
+// Parameters of the single vkShader_cull.comp dispatch that culls every batch.
+struct CullPushConstant
+{
+	glm::vec4 planes[6];      // xyz normal, w distance, from ExtractFrustumPlanes
+	uint32_t rangeFirst;      // this frame's first CullRange, also its first indirect command
+};
+
+// Visible instance indices with this bit set point into the static instance
+// buffer rather than the dynamic one.
+#define STATIC_INSTANCE_BIT 0x80000000u
+
+// One batch's entry in the cull range table (CullRange in vkShader_cull.comp,
+// std430). Workgroup row y of the cull dispatch culls range rangeFirst + y
+// into indirect command rangeFirst + y.
+struct CullRange
+{
+	glm::vec4 sphere;         // mesh-local bounding sphere, w radius
+	uint32_t instanceFirst;   // first dynamic transform, inside this frame's ring region
+	uint32_t instanceCount;
+	uint32_t staticFirst;     // first baked static transform
+	uint32_t staticCount;
+	uint32_t visibleFirst;    // first visible index slot, also the command's firstInstance
+	uint32_t padding[3];
+};
+
 struct LightingPushConstant
 {
 	alignas(16) glm::vec3 lightColor;    // Color of the light source
@@ -212,6 +232,27 @@ struct LightingUniformBuffer
     };
 
 
+// Size and owner of every VkDeviceMemory handed out by CreateBuffer/CreateImage,
+// so FreeDeviceMemory can credit the right MemoryTag.
+struct DeviceAllocation
+{
+    VkDeviceSize size;
+    MemoryTag tag;
+    uint32_t memoryTypeIndex;
+};
+
+// Every mesh's vertices and indices live in these shared device-local
+// buffers, one vertex buffer per VertexFormat since the strides differ.
+// Meshes are bump-allocated and, like the meshes themselves, never freed.
+struct GeometryPool {
+    VkBuffer vertexBuffers[VertexFormat_Count];
+    VkDeviceMemory vertexBufferMemory[VertexFormat_Count];
+    uint32_t vertexCount[VertexFormat_Count];
+    VkBuffer indexBuffer;
+    VkDeviceMemory indexBufferMemory;
+    uint32_t indexCount;
+};
+
 struct Data
 {
     bool vkFramebufferResized;
@@ -238,6 +279,7 @@ struct Data
     VkCommandPool vkCommandPool;
 
     VkPhysicalDeviceMemoryProperties vkMemProperties;
+    VkDeviceSize vkNonCoherentAtomSize;     // granularity of vkFlushMappedMemoryRanges
 
     std::vector<VkImage> vkDepthImages;
     std::vector<VkDeviceMemory> vkDepthImageMemorys;
@@ -260,14 +302,31 @@ struct Data
 
     uint32_t vkQueueFamilyCount = 0;  // TODO: FIX THIS
 
+    std::unordered_map<VkDeviceMemory, DeviceAllocation> vkDeviceAllocations;
+    GeometryPool vkGeometryPool;
+
 
 
 
     // CUSTOM CODE FOR RENDERS @TODO need to make this simpler
     VkDescriptorSetLayout vkDescriptorSetLayout;
     VkDescriptorSetLayout vkDescriptorSetLayout_blank;
+    VkDescriptorSetLayout vkInstanceDescriptorSetLayout;    // set 1 of every batch pipeline
+    VkDescriptorPool vkInstanceDescriptorPool;
+
+    // Batches are drawn from indirect commands whose firstInstance selects
+    // their visible indices; with multiDrawIndirect one call covers a run of batches.
+    bool vkDrawIndirectFirstInstance;
+    bool vkMultiDrawIndirect;
+
+    // GPU culling: vkShader_cull.comp counts each batch's visible instances
+    // into its indirect command.
+    bool vkGpuCulling;    // set at init when the graphics queue can also run compute
+    VkPipeline vkCullPipeline;
+    VkPipelineLayout vkCullPipelineLayout;
     std::vector<VkPushConstantRange> vkPushConstantRanges;
     VkPipeline vkGraphicsPipeline;
+    VkPipeline vkGraphicsPipelineCompact;
     VkPipeline vkGraphicsPipeline_blank;
     VkPipelineLayout vkPipelineLayout;
     VkShaderModule vkVertShaderModule;
@@ -294,6 +353,7 @@ struct Data
     VkDescriptorSetLayout vkLightingDescriptorSetLayout;
     VkDescriptorPool vkLightingDescriptorPool;
     VkPipeline vkLightingGraphicsPipeline;
+    VkPipeline vkLightingGraphicsPipelineCompact;
     VkPipelineLayout vkLightingPipelineLayout;
     VkShaderModule vkLightingVertShaderModule;
     VkShaderModule vkLightingFragShaderModule;
@@ -22,7 +22,7 @@ void CleanUpSwapChain(Renderer* renderer)
 {
     vkDestroyImageView(renderer->data.vkDevice, renderer->data.vkDepthImageView, nullptr);
     vkDestroyImage(renderer->data.vkDevice, renderer->data.vkDepthImage, nullptr);
-    vkFreeMemory(renderer->data.vkDevice, renderer->data.vkDepthImageMemory, nullptr);
+    FreeDeviceMemory(renderer, renderer->data.vkDepthImageMemory);
 
     for (size_t i = 0; i < renderer->data.vkSwapChainFramebuffers.size(); i++)
     {
@@ -98,6 +98,12 @@ void UpdateUniformBuffer(uint32_t currentImage, Renderer* renderer, Camera* cam)
     ubo.proj = glm::perspective(glm::radians(60.0f), renderer->data.vkSwapChainExtent.width / (float)renderer->data.vkSwapChainExtent.height, 0.1f, 1000.0f);
     ubo.proj[1][1] *= -1;
 
+    // Frustum culling tests against exactly what the shaders will use.
+    glm::mat4 viewProjection = ubo.proj * ubo.view;
+    memcpy(&cam->view, &ubo.view, sizeof(mat4));
+    memcpy(&cam->projection, &ubo.proj, sizeof(mat4));
+    memcpy(&cam->viewProjection, &viewProjection, sizeof(mat4));
+
     memcpy(renderer->data.vkUniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
 }
 
@@ -157,109 +163,694 @@ void BeginSwapChainRenderPass(Renderer* renderer, VkCommandBuffer commandBuffer)
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 }
 
-void UpdateInstanceBuffer(Mesh* mesh) {
-    if (!mesh->instanceDataRequiresGpuUpdate || mesh->instanceCount == 0) return;
+// Host-visible buffers of the batch storage, sized from its capacities. Each
+// holds MAX_FRAMES_IN_FLIGHT regions.
+void CreateBatchStorageBuffers(Renderer* renderer, BatchStorage* storage) {
+    VkDevice device = renderer->data.vkDevice;
+
+    // Coherence is not required; non-coherent memory gets explicit flushes.
+    VkDeviceSize instanceSize = sizeof(InstanceTransform) * storage->instanceCapacity * MAX_FRAMES_IN_FLIGHT;
+    CreateBuffer(renderer, instanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+                 storage->instanceBuffer, storage->instanceBufferMemory);
+    storage->instanceBufferMemorySize = renderer->data.vkDeviceAllocations[storage->instanceBufferMemory].size;
+    storage->instanceBufferCoherent = (GetDeviceMemoryPropertyFlags(renderer, storage->instanceBufferMemory) &
+                                       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    vkMapMemory(device, storage->instanceBufferMemory, 0, instanceSize, 0, &storage->instanceBufferMapped);
+
+    VkDeviceSize visibleSize = sizeof(uint32) * storage->visibleCapacity * MAX_FRAMES_IN_FLIGHT;
+    CreateBuffer(renderer, visibleSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 storage->visibleBuffer, storage->visibleBufferMemory);
+    vkMapMemory(device, storage->visibleBufferMemory, 0, visibleSize, 0, (void**)&storage->visibleBufferMapped);
+
+    VkDeviceSize commandSize = sizeof(VkDrawIndexedIndirectCommand) * storage->batchCapacity * MAX_FRAMES_IN_FLIGHT;
+    CreateBuffer(renderer, commandSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 storage->commandBuffer, storage->commandBufferMemory);
+    vkMapMemory(device, storage->commandBufferMemory, 0, commandSize, 0, (void**)&storage->commandsMapped);
+
+    VkDeviceSize rangeSize = sizeof(CullRange) * storage->batchCapacity * MAX_FRAMES_IN_FLIGHT;
+    CreateBuffer(renderer, rangeSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 storage->rangeBuffer, storage->rangeBufferMemory);
+    vkMapMemory(device, storage->rangeBufferMemory, 0, rangeSize, 0, (void**)&storage->rangesMapped);
+}
+
+void DestroyMappedBuffer(Renderer* renderer, VkBuffer buffer, VkDeviceMemory memory) {
+    vkUnmapMemory(renderer->data.vkDevice, memory);
+    vkDestroyBuffer(renderer->data.vkDevice, buffer, nullptr);
+    FreeDeviceMemory(renderer, memory);
+}
+
+void DestroyBatchStorageBuffers(Renderer* renderer, BatchStorage* storage) {
+    DestroyMappedBuffer(renderer, storage->instanceBuffer, storage->instanceBufferMemory);
+    DestroyMappedBuffer(renderer, storage->visibleBuffer, storage->visibleBufferMemory);
+    DestroyMappedBuffer(renderer, storage->commandBuffer, storage->commandBufferMemory);
+    DestroyMappedBuffer(renderer, storage->rangeBuffer, storage->rangeBufferMemory);
+}
+
+// Filled by BakeStaticBatches through a staging copy.
+void CreateStaticInstanceBuffer(Renderer* renderer, BatchStorage* storage, uint32 capacity) {
+    CreateBuffer(renderer, sizeof(InstanceTransform) * capacity,
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, storage->staticInstanceBuffer, storage->staticInstanceBufferMemory);
+    storage->staticCapacity = capacity;
+}
 
-    std::cout << "Updating instance buffer with " << mesh->instanceCount << " instances" << std::endl;
+void DestroyStaticInstanceBuffer(Renderer* renderer, BatchStorage* storage) {
+    vkDestroyBuffer(renderer->data.vkDevice, storage->staticInstanceBuffer, nullptr);
+    FreeDeviceMemory(renderer, storage->staticInstanceBufferMemory);
+    storage->staticInstanceBuffer = VK_NULL_HANDLE;
+    storage->staticInstanceBufferMemory = VK_NULL_HANDLE;
+}
 
-    for (uint32 i = 0; i < mesh->instanceCount; i++) {
-        ((InstancedData*)mesh->instanceBufferMapped)[i] = mesh->instanceData[i];
+// The set must not be in use by a frame in flight.
+void WriteBatchStorageDescriptorSet(Renderer* renderer, BatchStorage* storage) {
+    VkBuffer buffers[InstanceBinding_Count] = {};
+    buffers[InstanceBinding_Dynamic] = storage->instanceBuffer;
+    buffers[InstanceBinding_Static] = storage->staticInstanceBuffer;
+    buffers[InstanceBinding_Visible] = storage->visibleBuffer;
+    buffers[InstanceBinding_Commands] = storage->commandBuffer;
+    buffers[InstanceBinding_Ranges] = storage->rangeBuffer;
+
+    VkDescriptorBufferInfo bufferInfos[InstanceBinding_Count] = {};
+    VkWriteDescriptorSet descriptorWrites[InstanceBinding_Count] = {};
+    for (uint32 i = 0; i < InstanceBinding_Count; i++) {
+        bufferInfos[i].buffer = buffers[i];
+        bufferInfos[i].range = VK_WHOLE_SIZE;
+
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = storage->descriptorSet;
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = &bufferInfos[i];
     }
 
-    mesh->instanceDataRequiresGpuUpdate = false;
+    vkUpdateDescriptorSets(renderer->data.vkDevice, InstanceBinding_Count, descriptorWrites, 0, nullptr);
+}
+
+InstanceBounds MakeInstanceBounds(MAllocator* allocator) {
+    InstanceBounds bounds;
+    bounds.centerX = MakeMArray<real32>(allocator, 0, MemoryTag_Render);
+    bounds.centerY = MakeMArray<real32>(allocator, 0, MemoryTag_Render);
+    bounds.centerZ = MakeMArray<real32>(allocator, 0, MemoryTag_Render);
+    bounds.radius = MakeMArray<real32>(allocator, 0, MemoryTag_Render);
+    return bounds;
+}
+
+void DeallocateInstanceBounds(InstanceBounds* bounds) {
+    DeallocateMArray(&bounds->centerX);
+    DeallocateMArray(&bounds->centerY);
+    DeallocateMArray(&bounds->centerZ);
+    DeallocateMArray(&bounds->radius);
+}
+
+// Local-space sphere around the mesh bounds, radius in w.
+vec4 MeshBoundingSphere(Mesh* mesh) {
+    vec3 center = (mesh->boundsMin + mesh->boundsMax) * 0.5f;
+    return V4(center, Length(mesh->boundsMax - mesh->boundsMin) * 0.5f);
 }
 
-void RenderMeshInstanced(VkCommandBuffer commandBuffer, Mesh* mesh, VkDescriptorSet descriptorSet, VkPipelineLayout pipelineLayout) {
-    if (mesh->instanceCount == 0) return;
+// Places the mesh's bounding sphere at world. Non-uniform scale is covered by
+// growing the radius with the largest axis scale.
+void SetInstanceBounds(InstanceBounds* bounds, uint32 slot, Mesh* mesh, mat4 world) {
+    uint32 paddedCount = (slot + 4) & ~3u;
+    if (bounds->radius.count < paddedCount) {
+        Resize(&bounds->centerX, paddedCount);
+        Resize(&bounds->centerY, paddedCount);
+        Resize(&bounds->centerZ, paddedCount);
+        Resize(&bounds->radius, paddedCount);
+    }
 
-    UpdateInstanceBuffer(mesh);
+    vec4 sphere = MeshBoundingSphere(mesh);
+    real32 scale = Max(Length(world.columns[0].xyz), Max(Length(world.columns[1].xyz), Length(world.columns[2].xyz)));
 
-    VkBuffer vertexBuffers[] = { mesh->vertexBuffer, mesh->instanceBuffer };
-    VkDeviceSize offsets[] = { 0, 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    vec3 center = MultiplyPoint(world, sphere.xyz);
+    bounds->centerX[slot] = center.x;
+    bounds->centerY[slot] = center.y;
+    bounds->centerZ[slot] = center.z;
+    bounds->radius[slot] = sphere.w * scale;
+}
 
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(mesh->indices.size()), mesh->instanceCount, 0, 0, 0);
+void CopyInstanceBounds(InstanceBounds* bounds, uint32 dest, uint32 source) {
+    bounds->centerX[dest] = bounds->centerX[source];
+    bounds->centerY[dest] = bounds->centerY[source];
+    bounds->centerZ[dest] = bounds->centerZ[source];
+    bounds->radius[dest] = bounds->radius[source];
 }
 
-void ClearMeshInstances(Mesh* mesh) {
-    mesh->instanceCount = 0;
-    mesh->instanceData.count = 0;
-    mesh->registeredEntities.count = 0;
-    mesh->instanceDataRequiresGpuUpdate = true;
+uint32 CullInstanceBounds(FrustumPlanes* frustum, InstanceBounds* bounds, uint32 count, uint32 indexBase, uint32* visible) {
+    if (count == 0) return 0;
+    return CullSpheres(frustum, bounds->centerX.data, bounds->centerY.data, bounds->centerZ.data, bounds->radius.data,
+                       count, indexBase, visible);
 }
 
-void AddMeshInstance(Mesh* mesh, EntityHandle entityHandle, mat4 modelMatrix, vec3 objectColor, float materialIndex) {
-    if (mesh->instanceCount >= mesh->maxInstances) {
-        std::cout << "ERROR: Mesh instance limit reached!" << std::endl;
-        return;
+// Every ring region has to pick up the change, so the blocks are marked in all of them.
+inline void MarkBatchInstancesDirty(MaterialMeshBatch* batch, uint32 first, uint32 end) {
+    if (end <= first) return;
+
+    uint32 firstBlock = first / BATCH_DIRTY_BLOCK_SIZE;
+    uint32 lastBlock = (end - 1) / BATCH_DIRTY_BLOCK_SIZE;
+    for (uint32 f = 0; f < MAX_FRAMES_IN_FLIGHT; f++) {
+        for (uint32 block = firstBlock; block <= lastBlock; block++) {
+            batch->dirtyBlocks[f][block / 64] |= 1ull << (block % 64);
+        }
     }
+}
 
-    InstancedData instanceData = {};
-    instanceData.modelMatrix = modelMatrix;
-    instanceData.objectColor = glm::vec3(objectColor.x, objectColor.y, objectColor.z);
-    instanceData.materialIndex = materialIndex;
+#define BATCH_STORAGE_INITIAL_INSTANCES 4096
+#define BATCH_STORAGE_INITIAL_BATCHES 64
 
-    PushBack(&mesh->instanceData, instanceData);
-    PushBack(&mesh->registeredEntities, entityHandle);
-    mesh->instanceCount++;
-    mesh->instanceDataRequiresGpuUpdate = true;
+// Dynamic range a new batch starts with; GrowMaterialMeshBatch doubles it.
+#define BATCH_INITIAL_INSTANCES 64
 
-    std::cout << "Added mesh instance with color (" << objectColor.x << "," << objectColor.y << "," << objectColor.z << ") and material index " << materialIndex << ". Total instances: " << mesh->instanceCount << std::endl;
+void InitBatchStorage(Zayn* zaynMem) {
+    Renderer* renderer = &zaynMem->renderer;
+    BatchStorage* storage = &zaynMem->materialFactory.batchStorage;
+
+    VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = renderer->data.vkInstanceDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &renderer->data.vkInstanceDescriptorSetLayout;
+    if (vkAllocateDescriptorSets(renderer->data.vkDevice, &allocInfo, &storage->descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate instance descriptor set!");
+    }
+
+    // A one-instance placeholder until the first bake
+    CreateStaticInstanceBuffer(renderer, storage, 1);
+
+    storage->instanceCapacity = BATCH_STORAGE_INITIAL_INSTANCES;
+    storage->visibleCapacity = storage->instanceCapacity + storage->staticCapacity;
+    storage->batchCapacity = BATCH_STORAGE_INITIAL_BATCHES;
+    CreateBatchStorageBuffers(renderer, storage);
+    WriteBatchStorageDescriptorSet(renderer, storage);
+}
+
+// Replaces the host-visible buffers with ones of the given capacities. The
+// visible indices are resized to cover the current static buffer too.
+void ResizeBatchStorage(Zayn* zaynMem, uint32 instanceCapacity, uint32 batchCapacity) {
+    Renderer* renderer = &zaynMem->renderer;
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    BatchStorage* storage = &materialFactory->batchStorage;
+
+    // Frames in flight may still read the old buffers through the set
+    vkDeviceWaitIdle(renderer->data.vkDevice);
+    DestroyBatchStorageBuffers(renderer, storage);
+
+    storage->instanceCapacity = instanceCapacity;
+    storage->visibleCapacity = instanceCapacity + storage->staticCapacity;
+    storage->batchCapacity = batchCapacity;
+    CreateBatchStorageBuffers(renderer, storage);
+    WriteBatchStorageDescriptorSet(renderer, storage);
+
+    // The new ring regions start out empty
+    for (uint32 i = 0; i < materialFactory->drawOrder.count; i++) {
+        MaterialMeshBatch* batch = materialFactory->drawOrder[i];
+        MarkBatchInstancesDirty(batch, 0, batch->instanceCount);
+    }
+}
+
+inline uint32 GrowBatchStorageCapacity(uint32 capacity, uint32 required) {
+    while (capacity < required) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// Capacities at least double when they grow, so the idle wait in
+// ResizeBatchStorage is paid a logarithmic number of times.
+void ReserveBatchStorage(Zayn* zaynMem, uint32 instanceCount, uint32 batchCount) {
+    BatchStorage* storage = &zaynMem->materialFactory.batchStorage;
+    if (instanceCount <= storage->instanceCapacity && batchCount <= storage->batchCapacity) return;
+
+    ResizeBatchStorage(zaynMem, GrowBatchStorageCapacity(storage->instanceCapacity, instanceCount),
+                       GrowBatchStorageCapacity(storage->batchCapacity, batchCount));
+}
+
+// Lays the dynamic ranges out back to back in draw order, dropping the gaps
+// batches leave behind when they grow. Each ring region is only rewritten
+// when its own frame is next recorded, so frames in flight are unaffected.
+void PackBatchStorage(MaterialFactory* materialFactory) {
+    BatchStorage* storage = &materialFactory->batchStorage;
+
+    uint32 instanceUsed = 0;
+    for (uint32 i = 0; i < materialFactory->drawOrder.count; i++) {
+        MaterialMeshBatch* batch = materialFactory->drawOrder[i];
+        if (batch->instanceFirst != instanceUsed) {
+            batch->instanceFirst = instanceUsed;
+            MarkBatchInstancesDirty(batch, 0, batch->instanceCount);
+        }
+        instanceUsed += batch->maxInstances;
+    }
+    storage->instanceUsed = instanceUsed;
+}
+
+// Called once a range was claimed past the end of the used storage. Packing
+// comes first; the storage only grows if the ranges still do not fit.
+void FitBatchStorage(Zayn* zaynMem) {
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    BatchStorage* storage = &materialFactory->batchStorage;
+
+    if (storage->instanceUsed > storage->instanceCapacity) {
+        PackBatchStorage(materialFactory);
+    }
+    ReserveBatchStorage(zaynMem, storage->instanceUsed, materialFactory->drawOrder.count);
+}
+
+// Keeps each pipeline's batches together and, within them, each material's
+// batches of one vertex format, so those can share a multi-draw.
+inline bool BatchDrawsBefore(MaterialMeshBatch* a, MaterialMeshBatch* b) {
+    if (a->material->type != b->material->type) return a->material->type < b->material->type;
+    if (a->mesh->vertexFormat != b->mesh->vertexFormat) return a->mesh->vertexFormat < b->mesh->vertexFormat;
+    return a->material < b->material;
 }
 
 MaterialMeshBatch* GetOrCreateMaterialMeshBatch(Zayn* zaynMem, Mesh* mesh, Material* material) {
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
     auto key = std::make_pair(mesh, material);
-    auto it = zaynMem->materialFactory.materialMeshBatches.find(key);
+    auto it = materialFactory->materialMeshBatches.find(key);
     
-    if (it != zaynMem->materialFactory.materialMeshBatches.end()) {
+    if (it != materialFactory->materialMeshBatches.end()) {
         return it->second;
     }
     
     // Create new batch
-    MaterialMeshBatch* batch = new MaterialMeshBatch(); // Or use your memory arena
+    MaterialMeshBatch* batch = (MaterialMeshBatch*)AllocateMem(&materialFactory->batchPool, sizeof(MaterialMeshBatch));
+    memset(batch, 0, sizeof(MaterialMeshBatch));
     batch->mesh = mesh;
     batch->material = material;
-    batch->maxInstances = 1000; // Or whatever max you want
+    batch->maxInstances = BATCH_INITIAL_INSTANCES;
     batch->instanceCount = 0;
-    batch->instanceDataRequiresGpuUpdate = false;
     
     // Initialize dynamic arrays
-    batch->instanceData = MakeDynamicArray<InstancedData>(&zaynMem->permanentMemory, batch->maxInstances);
-    batch->registeredEntities = MakeDynamicArray<EntityHandle>(&zaynMem->permanentMemory, batch->maxInstances);
-    
-    // Create instance buffer for this batch
-    VkDeviceSize bufferSize = sizeof(InstancedData) * batch->maxInstances;
-    CreateBuffer(&zaynMem->renderer, bufferSize, 
-                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
-                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                 batch->instanceBuffer, batch->instanceBufferMemory);
+    batch->instanceData = MakeDynamicArray<InstanceTransform>(&zaynMem->generalMemory, batch->maxInstances, 1, MemoryTag_Render);
+    batch->registeredEntities = MakeDynamicArray<EntityHandle>(&zaynMem->generalMemory, batch->maxInstances, 1, MemoryTag_Render);
+
+    uint32 dirtyBlockCount = (batch->maxInstances + BATCH_DIRTY_BLOCK_SIZE - 1) / BATCH_DIRTY_BLOCK_SIZE;
+    for (uint32 f = 0; f < MAX_FRAMES_IN_FLIGHT; f++) {
+        batch->dirtyBlocks[f] = MakeMArray<uint64>(&zaynMem->generalMemory, 0, MemoryTag_Render);
+        Resize(&batch->dirtyBlocks[f], (dirtyBlockCount + 63) / 64);
+    }
+    batch->bounds = MakeInstanceBounds(&zaynMem->generalMemory);
+    batch->staticBounds = MakeInstanceBounds(&zaynMem->generalMemory);
     
-    vkMapMemory(zaynMem->renderer.data.vkDevice, batch->instanceBufferMemory, 0, bufferSize, 0, &batch->instanceBufferMapped);
+    uint32 position = PushBack(&materialFactory->drawOrder, batch);
+    while (position > 0 && BatchDrawsBefore(batch, materialFactory->drawOrder[position - 1])) {
+        materialFactory->drawOrder[position] = materialFactory->drawOrder[position - 1];
+        position--;
+    }
+    materialFactory->drawOrder[position] = batch;
+
+    // Claim the batch's range of the shared dynamic instance ring
+    BatchStorage* storage = &materialFactory->batchStorage;
+    batch->instanceFirst = storage->instanceUsed;
+    storage->instanceUsed += batch->maxInstances;
+    FitBatchStorage(zaynMem);
     
-    zaynMem->materialFactory.materialMeshBatches[key] = batch;
+    materialFactory->materialMeshBatches[key] = batch;
     return batch;
 }
 
+// Doubles the batch's dynamic range until it holds required instances. The
+// last range in the storage grows in place; any other moves to the end.
+void GrowMaterialMeshBatch(Zayn* zaynMem, MaterialMeshBatch* batch, uint32 required) {
+    BatchStorage* storage = &zaynMem->materialFactory.batchStorage;
+    uint32 oldMaxInstances = batch->maxInstances;
+    batch->maxInstances = GrowBatchStorageCapacity(oldMaxInstances, required);
+
+    uint32 dirtyBlockCount = (batch->maxInstances + BATCH_DIRTY_BLOCK_SIZE - 1) / BATCH_DIRTY_BLOCK_SIZE;
+    for (uint32 f = 0; f < MAX_FRAMES_IN_FLIGHT; f++) {
+        Resize(&batch->dirtyBlocks[f], (dirtyBlockCount + 63) / 64);
+    }
+
+    if (batch->instanceFirst + oldMaxInstances == storage->instanceUsed) {
+        storage->instanceUsed += batch->maxInstances - oldMaxInstances;
+    } else {
+        batch->instanceFirst = storage->instanceUsed;
+        storage->instanceUsed += batch->maxInstances;
+        MarkBatchInstancesDirty(batch, 0, batch->instanceCount);
+    }
+    FitBatchStorage(zaynMem);
+}
+
+// Batches only own CPU-side data; their GPU ranges go back with the storage reset in ClearMaterialMeshBatches.
+void DestroyMaterialMeshBatch(Zayn* zaynMem, MaterialMeshBatch* batch) {
+    DeallocateDynamicArray(&batch->instanceData);
+    DeallocateDynamicArray(&batch->registeredEntities);
+    for (uint32 f = 0; f < MAX_FRAMES_IN_FLIGHT; f++) {
+        DeallocateMArray(&batch->dirtyBlocks[f]);
+    }
+    DeallocateInstanceBounds(&batch->bounds);
+    DeallocateInstanceBounds(&batch->staticBounds);
+
+    DeallocateMem(&zaynMem->materialFactory.batchPool, batch);
+}
+
+void ClearMaterialMeshBatches(Zayn* zaynMem) {
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    if (materialFactory->materialMeshBatches.empty()) return;
+
+    for (auto& [key, batch] : materialFactory->materialMeshBatches) {
+        DestroyMaterialMeshBatch(zaynMem, batch);
+    }
+    materialFactory->materialMeshBatches.clear();
+    MArrayClear(&materialFactory->drawOrder);
+    MArrayClear(&materialFactory->batchInstanceRefs);
+    MArrayClear(&materialFactory->staticInstanceRefs);
+    MArrayClear(&materialFactory->staticPatches);
+    materialFactory->batchStorage.instanceUsed = 0;
+    materialFactory->staticInstancesBaked = 0;
+}
+
+// Copies the dirty blocks of one ring region into the mapped buffer, one copy
+// per run of adjacent blocks, and flushes just those runs when the memory is
+// not host-coherent. Upload cost follows the number of changed instances.
+void UploadDirtyBatchInstances(Zayn* zaynMem, MaterialMeshBatch* batch, uint32 frameIndex) {
+    Renderer* renderer = &zaynMem->renderer;
+    BatchStorage* storage = &zaynMem->materialFactory.batchStorage;
+    MArray<uint64>* dirtyBlocks = &batch->dirtyBlocks[frameIndex];
+
+    // The batch's range inside this frame's ring region
+    VkDeviceSize regionOffset = sizeof(InstanceTransform) * (storage->instanceCapacity * frameIndex + batch->instanceFirst);
+    InstanceTransform* region = (InstanceTransform*)((u8*)storage->instanceBufferMapped + regionOffset);
+    uint32 blockCount = (batch->instanceCount + BATCH_DIRTY_BLOCK_SIZE - 1) / BATCH_DIRTY_BLOCK_SIZE;
+
+    // Runs never touch, so there are at most half the blocks of them (rounded up)
+    VkMappedMemoryRange* flushRanges = nullptr;
+    uint32 flushCount = 0;
+    if (!storage->instanceBufferCoherent) {
+        flushRanges = PushArray(&zaynMem->frameMemory, VkMappedMemoryRange, blockCount / 2 + 1);
+    }
+
+    uint32 block = 0;
+    while (block < blockCount) {
+        uint64 word = (*dirtyBlocks)[block / 64];
+        if (word == 0 && block % 64 == 0) {
+            block += 64;
+            continue;
+        }
+        if (!(word & (1ull << (block % 64)))) {
+            block++;
+            continue;
+        }
+
+        uint32 runStart = block;
+        while (block < blockCount && ((*dirtyBlocks)[block / 64] & (1ull << (block % 64)))) {
+            block++;
+        }
+
+        uint32 first = runStart * BATCH_DIRTY_BLOCK_SIZE;
+        uint32 end = block * BATCH_DIRTY_BLOCK_SIZE;
+        if (end > batch->instanceCount) end = batch->instanceCount;
+        DynamicArrayCopyToContiguous(&batch->instanceData, region + first, first, end - first);
+
+        if (flushRanges) {
+            // Flush ranges must be aligned to nonCoherentAtomSize or reach the end of the allocation
+            VkDeviceSize atom = renderer->data.vkNonCoherentAtomSize;
+            VkDeviceSize rangeStart = (regionOffset + sizeof(InstanceTransform) * first) / atom * atom;
+            VkDeviceSize rangeEnd = (regionOffset + sizeof(InstanceTransform) * end + atom - 1) / atom * atom;
+            if (rangeEnd > storage->instanceBufferMemorySize) rangeEnd = storage->instanceBufferMemorySize;
+
+            VkMappedMemoryRange* range = &flushRanges[flushCount++];
+            *range = {};
+            range->sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range->memory = storage->instanceBufferMemory;
+            range->offset = rangeStart;
+            range->size = rangeEnd - rangeStart;
+        }
+    }
+
+    if (flushCount > 0) {
+        vkFlushMappedMemoryRanges(renderer->data.vkDevice, flushCount, flushRanges);
+    }
+
+    memset(dirtyBlocks->data, 0, sizeof(uint64) * dirtyBlocks->count);
+}
+
+// The ref only counts while the slot it points at still holds this handle.
+BatchInstanceRef* FindBatchInstance(MaterialFactory* materialFactory, EntityHandle handle) {
+    if (handle.indexInInfo < 0 || (uint32)handle.indexInInfo >= materialFactory->batchInstanceRefs.count) {
+        return nullptr;
+    }
+
+    BatchInstanceRef* ref = &materialFactory->batchInstanceRefs[handle.indexInInfo];
+    if (!ref->batch || ref->slot >= ref->batch->instanceCount || !(ref->batch->registeredEntities[ref->slot] == handle)) {
+        return nullptr;
+    }
+    return ref;
+}
+
+// An entity is drawn from at most one dynamic batch; adding it again is a no-op.
 void AddMeshInstance(Zayn* zaynMem, Mesh* mesh, Material* material, EntityHandle entityHandle, mat4 modelMatrix) {
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    if (FindBatchInstance(materialFactory, entityHandle)) return;
+
     MaterialMeshBatch* batch = GetOrCreateMaterialMeshBatch(zaynMem, mesh, material);
     
     if (batch->instanceCount >= batch->maxInstances) {
-        std::cout << "ERROR: Material-mesh batch instance limit reached!" << std::endl;
-        return;
+        GrowMaterialMeshBatch(zaynMem, batch, batch->instanceCount + 1);
     }
     
-    InstancedData instanceData = {};
-    instanceData.modelMatrix = modelMatrix;
-    
-    PushBack(&batch->instanceData, instanceData);
+    uint32 slot = PushBack(&batch->instanceData, MakeInstanceTransform(modelMatrix));
     PushBack(&batch->registeredEntities, entityHandle);
     batch->instanceCount++;
-    batch->instanceDataRequiresGpuUpdate = true;
+    MarkBatchInstancesDirty(batch, slot, slot + 1);
+    SetInstanceBounds(&batch->bounds, slot, mesh, modelMatrix);
+
+    if ((uint32)entityHandle.indexInInfo >= materialFactory->batchInstanceRefs.count) {
+        Resize(&materialFactory->batchInstanceRefs, entityHandle.indexInInfo + 1);
+    }
+    materialFactory->batchInstanceRefs[entityHandle.indexInInfo] = { batch, slot };
+}
+
+// O(1) through the reverse index: only the written slot is marked dirty.
+void UpdateEntityTransform(Zayn* zaynMem, EntityHandle handle, EntityType type, mat4 newTransform) {
+    BatchInstanceRef* ref = FindBatchInstance(&zaynMem->materialFactory, handle);
+    if (!ref) return;
+
+    ref->batch->instanceData[ref->slot] = MakeInstanceTransform(newTransform);
+    MarkBatchInstancesDirty(ref->batch, ref->slot, ref->slot + 1);
+    SetInstanceBounds(&ref->batch->bounds, ref->slot, ref->batch->mesh, newTransform);
+}
+
+// Swap-removes the entity's instance; the batch's last instance takes its
+// slot and has its reverse index entry patched.
+void RemoveEntityFromBatches(Zayn* zaynMem, EntityHandle handle) {
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    BatchInstanceRef* ref = FindBatchInstance(materialFactory, handle);
+    if (!ref) return;
+
+    MaterialMeshBatch* batch = ref->batch;
+    uint32 slot = ref->slot;
+    uint32 lastSlot = batch->instanceCount - 1;
+
+    if (slot != lastSlot) {
+        EntityHandle moved = batch->registeredEntities[lastSlot];
+        batch->instanceData[slot] = batch->instanceData[lastSlot];
+        batch->registeredEntities[slot] = moved;
+        materialFactory->batchInstanceRefs[moved.indexInInfo].slot = slot;
+        MarkBatchInstancesDirty(batch, slot, slot + 1);
+        CopyInstanceBounds(&batch->bounds, slot, lastSlot);
+    }
+
+    batch->instanceCount--;
+    batch->instanceData.count--;
+    batch->registeredEntities.count--;
+    *ref = {};
+}
+
+StaticInstanceRef* FindStaticInstance(MaterialFactory* materialFactory, EntityHandle handle) {
+    if (handle.indexInInfo < 0 || (uint32)handle.indexInInfo >= materialFactory->staticInstanceRefs.count) {
+        return nullptr;
+    }
+
+    StaticInstanceRef* ref = &materialFactory->staticInstanceRefs[handle.indexInInfo];
+    if (!ref->batch || !(ref->handle == handle)) {
+        return nullptr;
+    }
+    return ref;
+}
+
+// Patches a baked static instance in place; no rebake, no idle wait.
+void UpdateStaticInstance(Zayn* zaynMem, EntityHandle handle, mat4 newTransform) {
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    StaticInstanceRef* ref = FindStaticInstance(materialFactory, handle);
+    if (!ref) return;
+
+    MaterialMeshBatch* batch = ref->batch;
+    SetInstanceBounds(&batch->staticBounds, ref->slot, batch->mesh, newTransform);
+    PushBack(&materialFactory->staticPatches, { batch->staticFirst + ref->slot, MakeInstanceTransform(newTransform) });
+}
+
+// The slot stays in the static buffer until the next bake. Its transform is
+// zeroed, and both culling paths reject a sphere of radius zero.
+void HideStaticInstance(Zayn* zaynMem, EntityHandle handle) {
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    StaticInstanceRef* ref = FindStaticInstance(materialFactory, handle);
+    if (!ref) return;
+
+    InstanceTransform hidden;
+    for (uint32 row = 0; row < 3; row++) {
+        hidden.rows[row] = glm::vec4(0.0f);
+    }
+
+    MaterialMeshBatch* batch = ref->batch;
+    batch->staticBounds.radius[ref->slot] = 0.0f;
+    PushBack(&materialFactory->staticPatches, { batch->staticFirst + ref->slot, hidden });
+    *ref = {};
+}
+
+// Picks the variant of the material's pipeline built for the mesh's vertex format.
+VkPipeline GetMeshPipeline(Renderer* renderer, Material* material, Mesh* mesh) {
+    bool compact = mesh->vertexFormat == VertexFormat_Compact;
+    if (material->type == MATERIAL_LIGHTING) {
+        return compact ? renderer->data.vkLightingGraphicsPipelineCompact : renderer->data.vkLightingGraphicsPipeline;
+    }
+    return compact ? renderer->data.vkGraphicsPipelineCompact : renderer->data.vkGraphicsPipeline;
+}
+
+// Uploads each batch's changed instances and writes one indirect draw per
+// non-empty batch in draw order, its instances compacted into the batch's
+// slice of this frame's visible indices. The visible counts come from one
+// vkShader_cull.comp dispatch when the cull pipeline exists and from the CPU
+// otherwise. Must be recorded before the render pass begins.
+void CullMaterialBatches(Zayn* zaynMem, VkCommandBuffer commandBuffer) {
+    Renderer* renderer = &zaynMem->renderer;
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    BatchStorage* storage = &materialFactory->batchStorage;
+    uint32_t frameIndex = renderer->data.vkCurrentFrame % MAX_FRAMES_IN_FLIGHT;
+    FrustumPlanes frustum = ExtractFrustumPlanes(zaynMem->camera.viewProjection);
+    bool gpuCulling = renderer->data.vkGpuCulling;
+
+    // This frame's regions
+    uint32 instanceRegion = storage->instanceCapacity * frameIndex;
+    uint32 visibleRegion = storage->visibleCapacity * frameIndex;
+    uint32 commandBase = storage->batchCapacity * frameIndex;
+
+    // Static instances changed since the bake. Frames in flight may still read
+    // the buffer, so the writes wait for them and the reads below wait for the writes.
+    if (materialFactory->staticPatches.count > 0) {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        for (uint32 i = 0; i < materialFactory->staticPatches.count; i++) {
+            StaticInstancePatch* patch = &materialFactory->staticPatches[i];
+            vkCmdUpdateBuffer(commandBuffer, storage->staticInstanceBuffer, sizeof(InstanceTransform) * patch->index,
+                              sizeof(InstanceTransform), &patch->transform);
+        }
+        MArrayClear(&materialFactory->staticPatches);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    uint32 commandCount = 0;
+    uint32 visibleUsed = 0;
+    uint32 maxRangeInstances = 0;
+
+    for (uint32 i = 0; i < materialFactory->drawOrder.count; i++) {
+        MaterialMeshBatch* batch = materialFactory->drawOrder[i];
+        uint32 rangeInstances = batch->instanceCount + batch->staticInstanceCount;
+        if (rangeInstances == 0) continue;
+
+        // Only the blocks that changed since this ring region was last used are copied
+        UploadDirtyBatchInstances(zaynMem, batch, frameIndex);
+
+        uint32 commandIndex = commandBase + commandCount++;
+        uint32 visibleFirst = visibleRegion + visibleUsed;
+        visibleUsed += rangeInstances;
+
+        Mesh* mesh = batch->mesh;
+        VkDrawIndexedIndirectCommand* command = &storage->commandsMapped[commandIndex];
+        command->indexCount = mesh->indexCount;
+        command->firstIndex = mesh->firstIndex;
+        command->vertexOffset = mesh->vertexOffset;
+        command->firstInstance = visibleFirst;
+
+        if (!gpuCulling) {
+            uint32* visible = storage->visibleBufferMapped + visibleFirst;
+            uint32 visibleCount = CullInstanceBounds(&frustum, &batch->bounds, batch->instanceCount,
+                                                     instanceRegion + batch->instanceFirst, visible);
+            visibleCount += CullInstanceBounds(&frustum, &batch->staticBounds, batch->staticInstanceCount,
+                                               batch->staticFirst | STATIC_INSTANCE_BIT, visible + visibleCount);
+            command->instanceCount = visibleCount;
+            continue;
+        }
+
+        // The cull shader counts the survivors into the command
+        command->instanceCount = 0;
+
+        vec4 sphere = MeshBoundingSphere(mesh);
+        CullRange* range = &storage->rangesMapped[commandIndex];
+        range->sphere = glm::vec4(sphere.x, sphere.y, sphere.z, sphere.w);
+        range->instanceFirst = instanceRegion + batch->instanceFirst;
+        range->instanceCount = batch->instanceCount;
+        range->staticFirst = batch->staticFirst;
+        range->staticCount = batch->staticInstanceCount;
+        range->visibleFirst = visibleFirst;
+        if (rangeInstances > maxRangeInstances) maxRangeInstances = rangeInstances;
+    }
+
+    if (!gpuCulling || commandCount == 0) return;
+
+    CullPushConstant params = {};
+    for (int32 i = 0; i < 6; i++) {
+        params.planes[i] = glm::vec4(frustum.nx[i], frustum.ny[i], frustum.nz[i], frustum.d[i]);
+    }
+    params.rangeFirst = commandBase;
+
+    // One dispatch for every batch: workgroup row y culls range y
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, renderer->data.vkCullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, renderer->data.vkCullPipelineLayout, 0, 1,
+                            &storage->descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, renderer->data.vkCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(CullPushConstant), &params);
+    vkCmdDispatch(commandBuffer, (maxRangeInstances + 63) / 64, commandCount, 1);
+
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+// Issues drawCount consecutive indirect draws, in one call when the device
+// supports multiDrawIndirect. gl_InstanceIndex includes each command's
+// firstInstance, which points at its batch's visible indices.
+void DrawBatchCommands(Renderer* renderer, VkCommandBuffer commandBuffer, BatchStorage* storage, uint32 firstCommand, uint32 drawCount) {
+    uint32 stride = sizeof(VkDrawIndexedIndirectCommand);
+    if (renderer->data.vkMultiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(commandBuffer, storage->commandBuffer, (VkDeviceSize)stride * firstCommand, drawCount, stride);
+    } else if (renderer->data.vkDrawIndirectFirstInstance) {
+        for (uint32 i = 0; i < drawCount; i++) {
+            vkCmdDrawIndexedIndirect(commandBuffer, storage->commandBuffer, (VkDeviceSize)stride * (firstCommand + i), 1, stride);
+        }
+    } else {
+        // Only reached with CPU culling, so the counts are already known here
+        for (uint32 i = 0; i < drawCount; i++) {
+            VkDrawIndexedIndirectCommand* command = &storage->commandsMapped[firstCommand + i];
+            if (command->instanceCount == 0) continue;
+            vkCmdDrawIndexed(commandBuffer, command->indexCount, command->instanceCount, command->firstIndex,
+                             command->vertexOffset, command->firstInstance);
+        }
+    }
 }
 
 void RenderMaterialBatches(Zayn* zaynMem, VkCommandBuffer commandBuffer) {
-    uint32_t frameIndex = zaynMem->renderer.data.vkCurrentFrame % MAX_FRAMES_IN_FLIGHT;
+    Renderer* renderer = &zaynMem->renderer;
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    BatchStorage* storage = &materialFactory->batchStorage;
+    uint32_t frameIndex = renderer->data.vkCurrentFrame % MAX_FRAMES_IN_FLIGHT;
     
     // Get current light color for lighting materials
     vec3 globalLightColor = V3(1.0f, 1.0f, 1.0f);
@@ -271,221 +862,256 @@ void RenderMaterialBatches(Zayn* zaynMem, VkCommandBuffer commandBuffer) {
         }
     }
     
-    // Render each material batch
-    for (auto& [key, batch] : zaynMem->materialFactory.materialMeshBatches) {
-        if (batch->instanceCount == 0) continue;
-        
-        // Update instance buffer if needed
-        if (batch->instanceDataRequiresGpuUpdate) {
-            for (uint32_t i = 0; i < batch->instanceCount; i++) {
-                ((InstancedData*)batch->instanceBufferMapped)[i] = batch->instanceData[i];
-            }
-            batch->instanceDataRequiresGpuUpdate = false;
-        }
-        
+    // All meshes share the geometry pool: the index buffer is bound once and
+    // the vertex buffer only when the vertex format changes.
+    GeometryPool* geometryPool = &renderer->data.vkGeometryPool;
+    vkCmdBindIndexBuffer(commandBuffer, geometryPool->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    VertexFormat boundVertexFormat = VertexFormat_Count;
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+
+    // CullMaterialBatches has already written this frame's commands in draw
+    // order, so each run of one material and vertex format is one multi-draw.
+    uint32 commandIndex = storage->batchCapacity * frameIndex;
+    uint32 i = 0;
+    while (i < materialFactory->drawOrder.count) {
+        MaterialMeshBatch* batch = materialFactory->drawOrder[i];
         Material* material = batch->material;
         Mesh* mesh = batch->mesh;
-        
-        // Bind appropriate pipeline and update uniforms based on material type
+
+        uint32 drawCount = 0;
+        while (i < materialFactory->drawOrder.count &&
+               materialFactory->drawOrder[i]->material == material &&
+               materialFactory->drawOrder[i]->mesh->vertexFormat == mesh->vertexFormat) {
+            MaterialMeshBatch* runBatch = materialFactory->drawOrder[i];
+            if (runBatch->instanceCount + runBatch->staticInstanceCount > 0) drawCount++;
+            i++;
+        }
+        if (drawCount == 0) continue;
+
+        VkPipelineLayout pipelineLayout = renderer->data.vkPipelineLayout;
         if (material->type == MATERIAL_LIGHTING) {
             // Update this material's specific uniform buffer
             LightingUniformBuffer lightingUbo = {};
             lightingUbo.lightColor = glm::vec3(globalLightColor.x, globalLightColor.y, globalLightColor.z);
             lightingUbo.objectColor = glm::vec3(material->objectColor.x, material->objectColor.y, material->objectColor.z);
             memcpy(material->lightingUniformBuffersMapped[frameIndex], &lightingUbo, sizeof(lightingUbo));
-            
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, zaynMem->renderer.data.vkLightingGraphicsPipeline);
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                                  zaynMem->renderer.data.vkLightingPipelineLayout, 0, 1, 
-                                  &material->descriptorSets[frameIndex], 0, nullptr);
-        } else {
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, zaynMem->renderer.data.vkGraphicsPipeline);
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                                  zaynMem->renderer.data.vkPipelineLayout, 0, 1, 
-                                  &material->descriptorSets[frameIndex], 0, nullptr);
+            pipelineLayout = renderer->data.vkLightingPipelineLayout;
         }
-        
-        // Bind vertex and instance buffers
-        VkBuffer vertexBuffers[] = { mesh->vertexBuffer, batch->instanceBuffer };
-        VkDeviceSize offsets[] = { 0, 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-        
-        // Draw this batch
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(mesh->indices.size()), 
-                        batch->instanceCount, 0, 0, 0);
-    }
-}
-
-void RenderInstancedMeshesAlternative(Zayn* zaynMem, VkCommandBuffer commandBuffer) {
-    // Create a temporary structure to batch by mesh+material combination
-    struct RenderBatch {
-        Mesh* mesh;
-        Material* material;
-        std::vector<InstancedData> instanceData;
-        std::vector<EntityHandle> entities;
-    };
-
-    std::map<std::pair<Mesh*, Material*>, RenderBatch> renderBatches;
-
-    // First pass: organize entities by mesh+material
-    for (int i = 0; i < zaynMem->meshFactory.meshes.count; i++) {
-        Mesh* mesh = &zaynMem->meshFactory.meshes[i];
-        if (mesh->instanceCount == 0) continue;
-
-        for (uint32_t j = 0; j < mesh->instanceCount; j++) {
-            EntityHandle entityHandle = mesh->registeredEntities[j];
-            Material* material = nullptr;
-
-            if (entityHandle.type == EntityType_Wall) {
-                WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, entityHandle);
-                if (wall) material = wall->material;
-            } else if (entityHandle.type == EntityType_LightSource) {
-                LightSourceEntity* light = (LightSourceEntity*)GetEntity(&zaynMem->entityFactory, entityHandle);
-                if (light) material = light->material;
-            }
 
-            if (material) {
-                auto key = std::make_pair(mesh, material);
-                renderBatches[key].mesh = mesh;
-                renderBatches[key].material = material;
-                renderBatches[key].instanceData.push_back(mesh->instanceData[j]);
-                renderBatches[key].entities.push_back(entityHandle);
-            }
+        VkPipeline pipeline = GetMeshPipeline(renderer, material, mesh);
+        if (pipeline != boundPipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            boundPipeline = pipeline;
         }
-    }
-
-    // Second pass: render each batch separately
-    for (auto& [key, batch] : renderBatches) {
-        if (batch.instanceData.empty()) continue;
 
-        Mesh* mesh = batch.mesh;
-        Material* material = batch.material;
-        uint32_t frameIndex = zaynMem->renderer.data.vkCurrentFrame % MAX_FRAMES_IN_FLIGHT;
+        VkDescriptorSet descriptorSets[] = { material->descriptorSets[frameIndex], storage->descriptorSet };
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2,
+                                descriptorSets, 0, nullptr);
 
-        // CRITICAL FIX: Update the instance buffer with ONLY this batch's data
-        // This ensures each draw call uses the correct instance data
-        for (size_t i = 0; i < batch.instanceData.size(); i++) {
-            ((InstancedData*)mesh->instanceBufferMapped)[i] = batch.instanceData[i];
+        if (mesh->vertexFormat != boundVertexFormat) {
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &geometryPool->vertexBuffers[mesh->vertexFormat], &offset);
+            boundVertexFormat = mesh->vertexFormat;
         }
 
-        VkDescriptorSet& set = material->descriptorSets[frameIndex];
+        DrawBatchCommands(renderer, commandBuffer, storage, commandIndex, drawCount);
+        commandIndex += drawCount;
+    }
+}
 
-        // Choose pipeline and update uniforms based on material type
-        if (material->type == MATERIAL_LIGHTING) {
-            // Update lighting uniform buffer
-            LightingUniformBuffer lightingUbo = {};
-            lightingUbo.objectColor = glm::vec3(material->objectColor.x, material->objectColor.y, material->objectColor.z);
-            lightingUbo.lightColor = glm::vec3(1.0f, 1.0f, 1.0f); // Default white
+// Scheduler system: drains the entity factory's render events, moving
+// entities in and out of their batches. Baked static instances are hidden
+// rather than rebaked, and entities joining a batch do so as dynamic
+// instances, static or not. Work is proportional to the number of events.
+void ApplyRenderEventsSystem(Zayn* zaynMem, EntityTypeBuffer* unused, int32 first, int32 count, void* userData) {
+    EntityFactory* entityFactory = &zaynMem->entityFactory;
 
-            // Use actual light color if available
-            if (zaynMem->gameData.lightSources.count > 0) {
-                EntityHandle lightHandle = zaynMem->gameData.lightSources[0];
-                LightSourceEntity* light = (LightSourceEntity*)GetEntity(&zaynMem->entityFactory, lightHandle);
-                if (light) {
-                    lightingUbo.lightColor = glm::vec3(light->color.x, light->color.y, light->color.z);
-                }
+    for (RenderEvent& event : entityFactory->renderEvents) {
+        // Leave the batch the entity was filed under
+        if (event.type != RenderEvent_Created) {
+            RemoveEntityFromBatches(zaynMem, event.handle);
+            if (event.isStatic) {
+                HideStaticInstance(zaynMem, event.handle);
             }
-
-            memcpy(material->lightingUniformBuffersMapped[frameIndex], &lightingUbo, sizeof(lightingUbo));
-
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, zaynMem->renderer.data.vkLightingGraphicsPipeline);
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, zaynMem->renderer.data.vkLightingPipelineLayout, 0, 1, &set, 0, nullptr);
-        } else {
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, zaynMem->renderer.data.vkGraphicsPipeline);
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, zaynMem->renderer.data.vkPipelineLayout, 0, 1, &set, 0, nullptr);
         }
+        if (event.type == RenderEvent_Destroyed) continue;
 
-        // Bind buffers and draw this specific batch
-        VkBuffer vertexBuffers[] = { mesh->vertexBuffer, mesh->instanceBuffer };
-        VkDeviceSize offsets[] = { 0, 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        // Join the batch its columns name now; it may already be gone again
+        int32 slot = GetEntityIndexInBuffer(entityFactory, event.handle);
+        if (slot < 0) continue;
 
-        // Draw only the instances in this batch
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(mesh->indices.size()),
-                        static_cast<uint32_t>(batch.instanceData.size()), 0, 0, 0);
-        
-        // Debug output to help track what's being rendered
-        printf("Rendered batch: mesh=%s, material=%s, instances=%zu, color=(%.1f,%.1f,%.1f)\n",
-               mesh->name.c_str(), material->name.c_str(), batch.instanceData.size(),
-               material->objectColor.x, material->objectColor.y, material->objectColor.z);
+        EntityTypeBuffer* buffer = &entityFactory->buffers[event.handle.type];
+        Mesh* mesh = buffer->meshes[slot];
+        Material* material = buffer->materials[slot];
+        if (!mesh || !material) continue;
+        if (!GetEntityBase(buffer, slot)->isActive) continue;
+
+        // Static entities stay dynamic until BakeStaticBatches picks them up
+        AddMeshInstance(zaynMem, mesh, material, event.handle, buffer->worldMatrices[slot]);
     }
+
+    MArrayClear(&entityFactory->renderEvents);
 }
 
-void RenderInstancedMeshes(Zayn* zaynMem, VkCommandBuffer commandBuffer) {
-    // Use the alternative rendering method that groups by mesh+material
-    RenderInstancedMeshesAlternative(zaynMem, commandBuffer);
+// Scheduler system: copies the world matrix of every renderable entity the
+// transform systems touched this frame into its batch slot, or into its
+// baked static instance.
+// Runs after the transform systems, so world matrices are current.
+void SyncRenderTransformsSystem(Zayn* zaynMem, EntityTypeBuffer* buffer, int32 first, int32 count, void* userData) {
+    for (int32 slot = first; slot < first + count; slot++) {
+        if (!(buffer->transformFlags[slot] & TransformFlag_WorldChanged)) continue;
+        if (!buffer->meshes[slot] || !buffer->materials[slot]) continue;
+
+        EntityHandle handle = buffer->handles[slot];
+        if (buffer->isStatic[slot]) {
+            UpdateStaticInstance(zaynMem, handle, buffer->worldMatrices[slot]);
+        }
+        UpdateEntityTransform(zaynMem, handle, handle.type, buffer->worldMatrices[slot]);
+    }
 }
 
-void RenderEntities(Zayn* zaynMem, VkCommandBuffer commandBuffer) {
+// Uploads every active static entity's world matrix into the shared
+// device-local static instance buffer, each batch's instances contiguous,
+// through one staging buffer and one copy. Static entities drawn as dynamic
+// instances since the last bake leave their dynamic batches.
+void BakeStaticBatches(Zayn* zaynMem) {
+    Renderer* renderer = &zaynMem->renderer;
     EntityFactory* entityFactory = &zaynMem->entityFactory;
-    
-    // Clear all batches first
-    for (auto& [key, batch] : zaynMem->materialFactory.materialMeshBatches) {
-        batch->instanceCount = 0;
-        batch->instanceData.count = 0;
-        batch->registeredEntities.count = 0;
+    MaterialFactory* materialFactory = &zaynMem->materialFactory;
+    BatchStorage* storage = &materialFactory->batchStorage;
+
+    // The old static buffer may still be read by frames in flight.
+    vkDeviceWaitIdle(renderer->data.vkDevice);
+
+    for (uint32 i = 0; i < materialFactory->drawOrder.count; i++) {
+        materialFactory->drawOrder[i]->staticInstanceCount = 0;
     }
-    
-    // Populate batches with active entities
-    for (uint32_t i = 0; i < zaynMem->gameData.walls.count; i++) {
-        EntityHandle handle = zaynMem->gameData.walls[i];
-        WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
-        if (wall && wall->isActive && wall->mesh && wall->material) {
-            mat4 transform = TRS(wall->position, wall->rotation, wall->scale);
-            AddMeshInstance(zaynMem, wall->mesh, wall->material, handle, transform);
+    memset(materialFactory->staticInstanceRefs.data, 0, sizeof(StaticInstanceRef) * materialFactory->staticInstanceRefs.count);
+    MArrayClear(&materialFactory->staticPatches);
+
+    // First pass: count static instances per batch
+    uint32 totalCount = 0;
+    for (int32 type = 0; type < EntityType_Count; type++) {
+        EntityTypeBuffer* buffer = &entityFactory->buffers[type];
+        for (int32 slot = 0; slot < buffer->count; slot++) {
+            if (!buffer->isStatic[slot] || !buffer->meshes[slot] || !buffer->materials[slot]) continue;
+            if (!GetEntityBase(buffer, slot)->isActive) continue;
+
+            RemoveEntityFromBatches(zaynMem, buffer->handles[slot]);
+
+            MaterialMeshBatch* batch = GetOrCreateMaterialMeshBatch(zaynMem, buffer->meshes[slot], buffer->materials[slot]);
+            batch->staticInstanceCount++;
+            totalCount++;
         }
     }
-    
-    // Add light sources if they have visual representation
-    for (uint32_t i = 0; i < zaynMem->gameData.lightSources.count; i++) {
-        EntityHandle handle = zaynMem->gameData.lightSources[i];
-        LightSourceEntity* light = (LightSourceEntity*)GetEntity(&zaynMem->entityFactory, handle);
-        if (light && light->isActive && light->mesh && light->material) {
-            mat4 transform = TRS(light->position, V3(0,0,0), V3(0.2f, 0.2f, 0.2f));
-            AddMeshInstance(zaynMem, light->mesh, light->material, handle, transform);
-        }
+
+    materialFactory->staticInstancesBaked = totalCount;
+    materialFactory->staticBatchesDirty = false;
+
+    // Give each batch its range of the static buffer
+    uint32 staticFirst = 0;
+    for (uint32 i = 0; i < materialFactory->drawOrder.count; i++) {
+        MaterialMeshBatch* batch = materialFactory->drawOrder[i];
+        batch->staticFirst = staticFirst;
+        batch->staticUploadCursor = staticFirst;
+        staticFirst += batch->staticInstanceCount;
     }
-    
-    // Render all batches
-    RenderMaterialBatches(zaynMem, commandBuffer);
-}
 
-void UpdateEntityTransform(Zayn* zaynMem, EntityHandle handle, EntityType type, mat4 newTransform) {
-    // Find which batch this entity is in
-    for (auto& [key, batch] : zaynMem->materialFactory.materialMeshBatches) {
-        for (uint32_t i = 0; i < batch->instanceCount; i++) {
-            if (batch->registeredEntities[i].indexInInfo == handle.indexInInfo &&
-                batch->registeredEntities[i].generation == handle.generation) {
-                
-                batch->instanceData[i].modelMatrix = newTransform;
-                batch->instanceDataRequiresGpuUpdate = true;
-                return;
+    // Never empty, so the descriptor keeps a buffer to point at
+    DestroyStaticInstanceBuffer(renderer, storage);
+    CreateStaticInstanceBuffer(renderer, storage, totalCount > 0 ? totalCount : 1);
+    if (storage->instanceCapacity + storage->staticCapacity > storage->visibleCapacity) {
+        ResizeBatchStorage(zaynMem, storage->instanceCapacity, storage->batchCapacity);
+    } else {
+        WriteBatchStorageDescriptorSet(renderer, storage);
+    }
+
+    if (totalCount == 0) return;
+
+    VkDeviceSize stagingSize = sizeof(InstanceTransform) * totalCount;
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    CreateBuffer(renderer, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                 stagingBuffer, stagingBufferMemory);
+
+    InstanceTransform* staging;
+    vkMapMemory(renderer->data.vkDevice, stagingBufferMemory, 0, stagingSize, 0, (void**)&staging);
+
+    // Second pass: write each instance into its batch's range
+    for (int32 type = 0; type < EntityType_Count; type++) {
+        EntityTypeBuffer* buffer = &entityFactory->buffers[type];
+        for (int32 slot = 0; slot < buffer->count; slot++) {
+            if (!buffer->isStatic[slot] || !buffer->meshes[slot] || !buffer->materials[slot]) continue;
+            if (!GetEntityBase(buffer, slot)->isActive) continue;
+
+            MaterialMeshBatch* batch = GetOrCreateMaterialMeshBatch(zaynMem, buffer->meshes[slot], buffer->materials[slot]);
+            uint32 staticSlot = batch->staticUploadCursor - batch->staticFirst;
+            SetInstanceBounds(&batch->staticBounds, staticSlot, buffer->meshes[slot], buffer->worldMatrices[slot]);
+            staging[batch->staticUploadCursor++] = MakeInstanceTransform(buffer->worldMatrices[slot]);
+
+            EntityHandle handle = buffer->handles[slot];
+            if ((uint32)handle.indexInInfo >= materialFactory->staticInstanceRefs.count) {
+                Resize(&materialFactory->staticInstanceRefs, handle.indexInInfo + 1);
             }
+            materialFactory->staticInstanceRefs[handle.indexInInfo] = { batch, staticSlot, handle };
         }
     }
+
+    vkUnmapMemory(renderer->data.vkDevice, stagingBufferMemory);
+
+    VkCommandBuffer commandBuffer = BeginSingleTimeCommands(renderer);
+    VkBufferCopy copyRegion{};
+    copyRegion.size = stagingSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, storage->staticInstanceBuffer, 1, &copyRegion);
+    EndSingleTimeCommands(renderer, commandBuffer);
+
+    vkDestroyBuffer(renderer->data.vkDevice, stagingBuffer, nullptr);
+    FreeDeviceMemory(renderer, stagingBufferMemory);
 }
 
-void RemoveEntityFromBatches(Zayn* zaynMem, EntityHandle handle) {
-    for (auto& [key, batch] : zaynMem->materialFactory.materialMeshBatches) {
-        for (uint32_t i = 0; i < batch->instanceCount; i++) {
-            if (batch->registeredEntities[i].indexInInfo == handle.indexInInfo &&
-                batch->registeredEntities[i].generation == handle.generation) {
-                
-                // Remove by swapping with last
-                if (i < batch->instanceCount - 1) {
-                    batch->instanceData[i] = batch->instanceData[batch->instanceCount - 1];
-                    batch->registeredEntities[i] = batch->registeredEntities[batch->instanceCount - 1];
-                }
-                batch->instanceCount--;
-                batch->instanceDataRequiresGpuUpdate = true;
-                return;
-            }
-        }
+// Scheduler system: rebakes the static batches only when a bake was requested.
+void BakeStaticBatchesSystem(Zayn* zaynMem, EntityTypeBuffer* buffer, int32 first, int32 count, void* userData) {
+    if (zaynMem->materialFactory.staticBatchesDirty) {
+        BakeStaticBatches(zaynMem);
     }
 }
 
+void RegisterRenderSystems(Zayn* zaynMem) {
+    SystemScheduler* scheduler = &zaynMem->systemScheduler;
+
+    // Batch creation allocates Vulkan buffers, so these stay on the main thread.
+    SystemDesc applyEvents = {};
+    applyEvents.name = "ApplyRenderEvents";
+    applyEvents.update = ApplyRenderEventsSystem;
+    applyEvents.access.readTypes = ENTITY_TYPE_MASK_ALL;
+    applyEvents.access.writeResources = SystemResource_RenderBatches;
+    applyEvents.flags = SystemFlag_MainThread;
+    RegisterSystem(scheduler, &applyEvents);
+
+    SystemDesc syncTransforms = {};
+    syncTransforms.name = "SyncRenderTransforms";
+    syncTransforms.update = SyncRenderTransformsSystem;
+    syncTransforms.iterateTypes = ENTITY_TYPE_MASK_ALL;
+    syncTransforms.access.readTypes = ENTITY_TYPE_MASK_ALL;
+    syncTransforms.access.writeResources = SystemResource_RenderBatches;
+    syncTransforms.flags = SystemFlag_MainThread;
+    RegisterSystem(scheduler, &syncTransforms);
+
+    SystemDesc bakeStatic = {};
+    bakeStatic.name = "BakeStaticBatches";
+    bakeStatic.update = BakeStaticBatchesSystem;
+    bakeStatic.access.readTypes = ENTITY_TYPE_MASK_ALL;
+    bakeStatic.access.writeResources = SystemResource_RenderBatches;
+    bakeStatic.flags = SystemFlag_MainThread;
+    RegisterSystem(scheduler, &bakeStatic);
+}
+
+// Batches are filled by the scheduler's render systems before the frame is recorded.
+void RenderEntities(Zayn* zaynMem, VkCommandBuffer commandBuffer) {
+    RenderMaterialBatches(zaynMem, commandBuffer);
+}
+
 void EndSwapChainRenderPass(Renderer* renderer, VkCommandBuffer commandBuffer)
 {
     assert(renderer->data.vkIsFrameStarted && "Can't call beginSwapChainRenderPass if frame is not in progress");
@@ -494,7 +1120,7 @@ void EndSwapChainRenderPass(Renderer* renderer, VkCommandBuffer commandBuffer)
     vkCmdEndRenderPass(commandBuffer);
 }
 
-VkResult SubmitCommandBuffers(Renderer* renderer, std::vector<VkCommandBuffer> buffers, uint32_t* imageIndex)
+VkResult SubmitCommandBuffers(Renderer* renderer, VkCommandBuffer* buffers, uint32_t bufferCount, uint32_t* imageIndex)
 {
 
     if (renderer->data.vkImagesInFlight[*imageIndex] != VK_NULL_HANDLE)
@@ -511,8 +1137,8 @@ VkResult SubmitCommandBuffers(Renderer* renderer, std::vector<VkCommandBuffer> b
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
-    submitInfo.commandBufferCount = static_cast<uint32_t>(buffers.size());
-    submitInfo.pCommandBuffers = buffers.data();
+    submitInfo.commandBufferCount = bufferCount;
+    submitInfo.pCommandBuffers = buffers;
 
     VkSemaphore signalSemaphores[] = { renderer->data.vkRenderFinishedSemaphores[*imageIndex] };
     submitInfo.signalSemaphoreCount = 1;
@@ -546,12 +1172,13 @@ VkResult SubmitCommandBuffers(Renderer* renderer, std::vector<VkCommandBuffer> b
 void EndFrameRender(Renderer* renderer, WindowManager* windowManager)
 {
     assert(renderer->data.vkIsFrameStarted && "Can't call endFrame while frame is not in progress");
-    std::vector<VkCommandBuffer> submitCommandBuffers = {};
-    submitCommandBuffers.push_back(renderer->data.vkCommandBuffers[renderer->data.vkCurrentFrame]);
+    VkCommandBuffer submitCommandBuffers[2] = {};
+    uint32_t submitCommandBufferCount = 0;
+    submitCommandBuffers[submitCommandBufferCount++] = renderer->data.vkCommandBuffers[renderer->data.vkCurrentFrame];
 
 #if IMGUI
     if (renderer->myImgui.visible) {
-        submitCommandBuffers.push_back(renderer->myImgui.imGuiCommandBuffers[renderer->data.vkCurrentFrame]);
+        submitCommandBuffers[submitCommandBufferCount++] = renderer->myImgui.imGuiCommandBuffers[renderer->data.vkCurrentFrame];
     }
 #endif
 
@@ -560,7 +1187,7 @@ void EndFrameRender(Renderer* renderer, WindowManager* windowManager)
         throw std::runtime_error("failed to record command buffer!");
     }
 
-    auto result = SubmitCommandBuffers(renderer, submitCommandBuffers, &renderer->data.vkCurrentImageIndex);
+    auto result = SubmitCommandBuffers(renderer, submitCommandBuffers, submitCommandBufferCount, &renderer->data.vkCurrentImageIndex);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || renderer->data.vkFramebufferResized)
     {
@@ -580,7 +1207,9 @@ void UpdateRenderer(Zayn* zaynMem, Renderer* renderer, WindowManager* windowMana
     {
 
         UpdateUniformBuffer(renderer->data.vkCurrentFrame, renderer, camera);
-        // Note: UpdateLightingUniformBuffer is now called per-material in RenderInstancedMeshes
+        // Compute culling cannot be recorded inside the render pass
+        CullMaterialBatches(zaynMem, renderer->data.vkCommandBuffers[renderer->data.vkCurrentFrame]);
+        // Note: UpdateLightingUniformBuffer is now called per-material in RenderMaterialBatches
         BeginSwapChainRenderPass(renderer, renderer->data.vkCommandBuffers[renderer->data.vkCurrentFrame]);
 
         if (false) {
@@ -659,39 +1288,37 @@ void UpdateMyImgui(Zayn* zaynMem, LevelEditor* editor, Camera* camera, Renderer*
             ImGui::Text("Selected Entity: %s (ID: %d)", entityTypeName, handle.indexInInfo);
 
             if (editor->selectedEntity.type == EntityType_Wall) {
-                WallEntity* wall = (WallEntity*)GetEntity(&zaynMem->entityFactory, handle);
-                if (wall) {
+                int32 slot = GetEntityIndexInBuffer(&zaynMem->entityFactory, handle);
+                if (slot >= 0) {
+                    EntityTypeBuffer* walls = &zaynMem->entityFactory.buffers[EntityType_Wall];
+
                     ImGui::Separator();
                     ImGui::Text("Transform");
 
                     bool changed = false;
-                    changed |= ImGui::DragFloat3("Position", &wall->position.x, 0.1f);
-                    changed |= ImGui::DragFloat3("Rotation", &wall->rotation.x, 1.0f);
-                    changed |= ImGui::DragFloat3("Scale", &wall->scale.x, 0.1f, 0.1f, 10.0f);
-
-                    if (changed && wall->mesh) {
-                        for (uint32 i = 0; i < wall->mesh->instanceCount; i++) {
-                            EntityHandle instanceHandle = wall->mesh->registeredEntities[i];
-                            if (instanceHandle.indexInInfo == handle.indexInInfo &&
-                                instanceHandle.generation == handle.generation) {
-
-                                mat4 newTransform = TRS(wall->position, wall->rotation, wall->scale);
-                                wall->mesh->instanceData[i].modelMatrix = newTransform;
-                                wall->mesh->instanceDataRequiresGpuUpdate = true;
-                                break;
-                            }
-                        }
+                    changed |= ImGui::DragFloat3("Position", &walls->positions[slot].x, 0.1f);
+                    changed |= ImGui::DragFloat3("Rotation", &walls->rotations[slot].x, 1.0f);
+                    changed |= ImGui::DragFloat3("Scale", &walls->scales[slot].x, 0.1f, 0.1f, 10.0f);
+                    if (changed) {
+                        // SyncRenderTransforms writes just this entity's batch slot
+                        MarkTransformDirty(walls, slot);
                     }
                 }
             }
             else if (editor->selectedEntity.type == EntityType_LightSource) {
                 LightSourceEntity* light = (LightSourceEntity*)GetEntity(&zaynMem->entityFactory, handle);
                 if (light) {
+                    EntityTypeBuffer* lights = &zaynMem->entityFactory.buffers[EntityType_LightSource];
+                    int32 slot = GetEntityIndexInBuffer(&zaynMem->entityFactory, handle);
+
                     ImGui::Separator();
                     ImGui::Text("Transform");
 
                     bool changed = false;
-                    changed |= ImGui::DragFloat3("Position", &light->position.x, 0.1f);
+                    changed |= ImGui::DragFloat3("Position", &lights->positions[slot].x, 0.1f);
+                    if (changed) {
+                        MarkTransformDirty(lights, slot);
+                    }
 
                     ImGui::Separator();
                     ImGui::Text("Light Settings");
@@ -714,21 +1341,6 @@ void UpdateMyImgui(Zayn* zaynMem, LevelEditor* editor, Camera* camera, Renderer*
                     if (ImGui::Button("Yellow")) { light->color = V3(1.0f, 1.0f, 0.0f); changed = true; }
                     ImGui::SameLine();
                     if (ImGui::Button("Purple")) { light->color = V3(1.0f, 0.0f, 1.0f); changed = true; }
-
-                    // Update mesh instance position if changed
-                    if (changed && light->mesh) {
-                        for (uint32 i = 0; i < light->mesh->instanceCount; i++) {
-                            EntityHandle instanceHandle = light->mesh->registeredEntities[i];
-                            if (instanceHandle.indexInInfo == handle.indexInInfo &&
-                                instanceHandle.generation == handle.generation) {
-
-                                mat4 newTransform = TRS(light->position, V3(0,0,0), V3(0.2f, 0.2f, 0.2f));
-                                light->mesh->instanceData[i].modelMatrix = newTransform;
-                                light->mesh->instanceDataRequiresGpuUpdate = true;
-                                break;
-                            }
-                        }
-                    }
                 }
             }
         } else {
@@ -853,17 +1465,17 @@ void UpdateMyImgui(Zayn* zaynMem, LevelEditor* editor, Camera* camera, Renderer*
         // Mesh selection
         ImGui::Text("Mesh:");
         if (zaynMem->meshFactory.meshes.count > 0) {
-            static std::vector<const char*> meshNames;
-            meshNames.clear();
-            for (uint32 i = 0; i < zaynMem->meshFactory.meshes.count; i++) {
-                meshNames.push_back(zaynMem->meshFactory.meshes[i].name.c_str());
+            uint32 meshNameCount = zaynMem->meshFactory.meshes.count;
+            const char** meshNames = PushArray(&zaynMem->frameMemory, const char*, meshNameCount);
+            for (uint32 i = 0; i < meshNameCount; i++) {
+                meshNames[i] = zaynMem->meshFactory.meshes[i].name.c_str();
             }
             
-            if (editor->selectedMeshForCreation >= meshNames.size()) {
+            if (editor->selectedMeshForCreation >= meshNameCount) {
                 editor->selectedMeshForCreation = 0;
             }
             
-            ImGui::Combo("##Mesh", &editor->selectedMeshForCreation, meshNames.data(), meshNames.size());
+            ImGui::Combo("##Mesh", &editor->selectedMeshForCreation, meshNames, meshNameCount);
         } else {
             ImGui::Text("No meshes available");
         }
@@ -871,17 +1483,17 @@ void UpdateMyImgui(Zayn* zaynMem, LevelEditor* editor, Camera* camera, Renderer*
         // Material selection - keep it simple to avoid index mismatch
         ImGui::Text("Material:");
         if (zaynMem->materialFactory.materials.count > 0) {
-            static std::vector<const char*> materialNames;
-            materialNames.clear();
-            for (uint32 i = 0; i < zaynMem->materialFactory.materials.count; i++) {
-                materialNames.push_back(zaynMem->materialFactory.materials[i].name.c_str());
+            uint32 materialNameCount = zaynMem->materialFactory.materials.count;
+            const char** materialNames = PushArray(&zaynMem->frameMemory, const char*, materialNameCount);
+            for (uint32 i = 0; i < materialNameCount; i++) {
+                materialNames[i] = zaynMem->materialFactory.materials[i].name.c_str();
             }
             
-            if (editor->selectedMaterialForCreation >= materialNames.size()) {
+            if (editor->selectedMaterialForCreation >= materialNameCount) {
                 editor->selectedMaterialForCreation = 0;
             }
             
-            ImGui::Combo("##Material", &editor->selectedMaterialForCreation, materialNames.data(), materialNames.size());
+            ImGui::Combo("##Material", &editor->selectedMaterialForCreation, materialNames, materialNameCount);
             
             // Show helpful text about material type
             if (editor->selectedMaterialForCreation < zaynMem->materialFactory.materials.count) {
@@ -932,9 +1544,67 @@ void UpdateMyImgui(Zayn* zaynMem, LevelEditor* editor, Camera* camera, Renderer*
         ImGui::Text("Statistics");
         ImGui::Text("Walls: %d", zaynMem->gameData.walls.count);
         ImGui::Text("Light Sources: %d", zaynMem->gameData.lightSources.count);
+        ImGui::Text("Static Instances (baked): %u", zaynMem->materialFactory.staticInstancesBaked);
+        ImGui::SameLine();
+        if (ImGui::Button("Rebake")) {
+            zaynMem->materialFactory.staticBatchesDirty = true;
+        }
+        ImGui::Checkbox("Show Memory", &editor->showMemoryWindow);
     }
     ImGui::End();
 
+    if (editor->showMemoryWindow) {
+        if (ImGui::Begin("Memory", &editor->showMemoryWindow)) {
+            const real32 kb = 1024.0f;
+
+            ImGui::Text("Arenas (KB)");
+            ImGui::Text("Frame: %.1f / peak %.1f", zaynMem->frameMemory.size / kb, zaynMem->frameMemory.peakSize / kb);
+            ImGui::Text("Permanent: %.1f / peak %.1f", zaynMem->permanentMemory.size / kb, zaynMem->permanentMemory.peakSize / kb);
+            uint32 threadCount = zaynMem->threadMemory.registeredThreadCount.load();
+            for (uint32 i = 0; i < threadCount; i++) {
+                MemoryArena* arena = &zaynMem->threadMemory.threadArenas[i].frameArena;
+                ImGui::Text("Thread %d: %.1f / peak %.1f", i, arena->size / kb, arena->peakSize / kb);
+            }
+
+            ImGui::Separator();
+            ImGui::Text("General allocator: %.1f KB / peak %.1f KB",
+                        zaynMem->generalMemory.stats.bytesInUse / kb, zaynMem->generalMemory.stats.peakBytesInUse / kb);
+
+            ImGui::Separator();
+            EntityFactory* entityFactory = &zaynMem->entityFactory;
+            ImGui::Text("Entity ids: %d / %d (%d free)", entityFactory->nextID, entityFactory->entityCapacity, entityFactory->freeList.count);
+            for (int32 i = 0; i < EntityType_Count; i++) {
+                ImGui::Text("%s: %d / %d", entityFactory->entityTypeInfoForBuffer[i].typeName,
+                            entityFactory->buffers[i].count, entityFactory->buffers[i].capacity);
+            }
+
+            ImGui::Separator();
+            if (ImGui::BeginTable("MemoryTags", 5)) {
+                ImGui::TableSetupColumn("Tag");
+                ImGui::TableSetupColumn("CPU KB");
+                ImGui::TableSetupColumn("CPU peak");
+                ImGui::TableSetupColumn("GPU KB");
+                ImGui::TableSetupColumn("GPU peak");
+                ImGui::TableHeadersRow();
+
+                for (int32 i = 0; i < MemoryTag_Count; i++) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::Text("%s", MemoryTagNames[i]);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", memoryTracker.cpu[i].bytesInUse / kb);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", memoryTracker.cpu[i].peakBytesInUse / kb);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", memoryTracker.gpu[i].bytesInUse / kb);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", memoryTracker.gpu[i].peakBytesInUse / kb);
+                }
+                ImGui::EndTable();
+            }
+
+            if (ImGui::Button("Dump Memory Stats")) {
+                DumpMemoryStats(zaynMem, "memory_stats.json");
+            }
+        }
+        ImGui::End();
+    }
+
     ImGui::Render();
 
     VkCommandBuffer cmd = renderer->myImgui.imGuiCommandBuffers[renderer->data.vkCurrentFrame];
@@ -343,6 +343,10 @@ void PickPhysicalDevice(Renderer* renderer)
     {
         throw std::runtime_error("failed to find a suitable GPU!");
     }
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(renderer->data.vkPhysicalDevice, &deviceProperties);
+    renderer->data.vkNonCoherentAtomSize = deviceProperties.limits.nonCoherentAtomSize;
 }
 
 void CreateLogicalDevice(Renderer* renderer)
@@ -363,9 +367,15 @@ void CreateLogicalDevice(Renderer* renderer)
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(renderer->data.vkPhysicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
     deviceFeatures.sampleRateShading = VK_TRUE;
+    // Optional: without them batches fall back to one draw call each
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect && supportedFeatures.drawIndirectFirstInstance;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -395,6 +405,18 @@ void CreateLogicalDevice(Renderer* renderer)
 
     vkGetDeviceQueue(renderer->data.vkDevice, indices.graphicsFamily.value(), 0, &renderer->data.vkGraphicsQueue);
     vkGetDeviceQueue(renderer->data.vkDevice, indices.presentFamily.value(), 0,  &renderer->data.vkPresentQueue);
+
+    renderer->data.vkDrawIndirectFirstInstance = deviceFeatures.drawIndirectFirstInstance;
+    renderer->data.vkMultiDrawIndirect = deviceFeatures.multiDrawIndirect;
+
+    // Culling dispatches are recorded into the frame's graphics command buffer,
+    // and their counts only reach the draws through indirect commands
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(renderer->data.vkPhysicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(renderer->data.vkPhysicalDevice, &queueFamilyCount, queueFamilies.data());
+    renderer->data.vkGpuCulling = (queueFamilies[indices.graphicsFamily.value()].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 &&
+                                  renderer->data.vkDrawIndirectFirstInstance;
 }
 
 VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats)
@@ -718,7 +740,8 @@ void CreateImage(uint32_t width,
                  VkMemoryPropertyFlags properties,
                  VkImage& image,
                  VkDeviceMemory& imageMemory,
-                 Renderer* renderer)
+                 Renderer* renderer,
+                 MemoryTag tag = MemoryTag_Render)
 {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -753,6 +776,9 @@ void CreateImage(uint32_t width,
         throw std::runtime_error("failed to allocate image memory!");
     }
 
+    renderer->data.vkDeviceAllocations[imageMemory] = {memRequirements.size, tag, allocInfo.memoryTypeIndex};
+    TrackDeviceAllocation(tag, memRequirements.size);
+
     vkBindImageMemory(renderer->data.vkDevice, image, imageMemory, 0);
 }
 
@@ -767,19 +793,6 @@ VkCommandBuffer BeginSingleTimeCommands(Renderer* renderer)
     VkCommandBuffer commandBuffer;
     vkAllocateCommandBuffers(renderer->data.vkDevice, &allocInfo, &commandBuffer);
 
-#if IMGUI
-    renderer->myImgui.imGuiCommandBuffers.resize(
-    renderer->data.vkSwapChainImageViews.size());
-
-    allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = renderer->myImgui.imGuiCommandPool;
-    allocInfo.commandBufferCount =
-    static_cast<uint32_t>(renderer->myImgui.imGuiCommandBuffers.size());
-    vkAllocateCommandBuffers(renderer->data.vkDevice, &allocInfo, renderer->myImgui.imGuiCommandBuffers.data());
-#endif
-
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
@@ -1123,7 +1136,7 @@ void CopyBuffer(Renderer* renderer, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDe
     EndSingleTimeCommands(renderer, commandBuffer);
 }
 
-void CreateBuffer(Renderer* renderer, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+void CreateBuffer(Renderer* renderer, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, MemoryTag tag = MemoryTag_Render)
 {
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -1149,9 +1162,79 @@ void CreateBuffer(Renderer* renderer, VkDeviceSize size, VkBufferUsageFlags usag
         throw std::runtime_error("failed to allocate buffer memory!");
     }
 
+    renderer->data.vkDeviceAllocations[bufferMemory] = {memRequirements.size, tag, allocInfo.memoryTypeIndex};
+    TrackDeviceAllocation(tag, memRequirements.size);
+
     vkBindBufferMemory(renderer->data.vkDevice, buffer, bufferMemory, 0);
 }
 
+// Use instead of vkFreeMemory for anything that came from CreateBuffer/CreateImage.
+void FreeDeviceMemory(Renderer* renderer, VkDeviceMemory memory)
+{
+    auto it = renderer->data.vkDeviceAllocations.find(memory);
+    if (it != renderer->data.vkDeviceAllocations.end())
+    {
+        TrackDeviceFree(it->second.tag, it->second.size);
+        renderer->data.vkDeviceAllocations.erase(it);
+    }
+
+    vkFreeMemory(renderer->data.vkDevice, memory, nullptr);
+}
+
+// Copies size bytes to dstOffset of a device-local buffer through a staging buffer.
+void UploadToBuffer(Renderer* renderer, const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset)
+{
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    CreateBuffer(renderer, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, MemoryTag_Mesh);
+
+    void* mapped;
+    vkMapMemory(renderer->data.vkDevice, stagingBufferMemory, 0, size, 0, &mapped);
+    memcpy(mapped, data, (size_t)size);
+    vkUnmapMemory(renderer->data.vkDevice, stagingBufferMemory);
+
+    VkCommandBuffer commandBuffer = BeginSingleTimeCommands(renderer);
+    VkBufferCopy copyRegion{};
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+    EndSingleTimeCommands(renderer, commandBuffer);
+
+    vkDestroyBuffer(renderer->data.vkDevice, stagingBuffer, nullptr);
+    FreeDeviceMemory(renderer, stagingBufferMemory);
+}
+
+#define GEOMETRY_POOL_VERTICES (1 << 18)    // per vertex format
+#define GEOMETRY_POOL_INDICES (1 << 20)
+
+uint32_t GetVertexStride(VertexFormat format)
+{
+    return format == VertexFormat_Compact ? sizeof(VertexCompact) : sizeof(Vertex);
+}
+
+void InitGeometryPool(Renderer* renderer)
+{
+    GeometryPool* pool = &renderer->data.vkGeometryPool;
+    for (uint32_t format = 0; format < VertexFormat_Count; format++)
+    {
+        VkDeviceSize bufferSize = (VkDeviceSize)GetVertexStride((VertexFormat)format) * GEOMETRY_POOL_VERTICES;
+        CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pool->vertexBuffers[format], pool->vertexBufferMemory[format], MemoryTag_Mesh);
+        pool->vertexCount[format] = 0;
+    }
+
+    VkDeviceSize indexBufferSize = sizeof(uint32_t) * GEOMETRY_POOL_INDICES;
+    CreateBuffer(renderer, indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pool->indexBuffer, pool->indexBufferMemory, MemoryTag_Mesh);
+    pool->indexCount = 0;
+}
+
+// Property flags of the memory type an allocation from CreateBuffer/CreateImage landed in.
+VkMemoryPropertyFlags GetDeviceMemoryPropertyFlags(Renderer* renderer, VkDeviceMemory memory)
+{
+    auto it = renderer->data.vkDeviceAllocations.find(memory);
+    assert(it != renderer->data.vkDeviceAllocations.end());
+    return renderer->data.vkMemProperties.memoryTypes[it->second.memoryTypeIndex].propertyFlags;
+}
+
 void CreateDescriptorSetLayout(Renderer* renderer, VkDescriptorSetLayout* descriptorSetLayout, bool hasImage, bool hasLighting = false)
 {
     std::vector<VkDescriptorSetLayoutBinding> bindings = {};
@@ -1221,6 +1304,57 @@ void CreateDescriptorPool(Renderer* renderer, VkDescriptorPool* descriptorPool,
     }
 }
 
+// Bindings of the batch storage set (BatchStorage in material_factory.h).
+enum InstanceBinding
+{
+    InstanceBinding_Dynamic,     // dynamic InstanceTransforms
+    InstanceBinding_Static,      // baked static InstanceTransforms
+    InstanceBinding_Visible,     // visible instance indices, read with gl_InstanceIndex
+    InstanceBinding_Commands,    // indirect draws culling counts into
+    InstanceBinding_Ranges,      // CullRange table
+
+    InstanceBinding_Count,
+};
+
+// Set 1 of the batch pipelines and set 0 of the culling pipeline. All
+// batches share the one set; both stages see every binding.
+void InitInstanceDescriptors(Renderer* renderer)
+{
+    std::array<VkDescriptorSetLayoutBinding, InstanceBinding_Count> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(renderer->data.vkDevice, &layoutInfo, nullptr, &renderer->data.vkInstanceDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create instance descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = InstanceBinding_Count;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(renderer->data.vkDevice, &poolInfo, nullptr, &renderer->data.vkInstanceDescriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create instance descriptor pool!");
+    }
+}
+
 VkShaderModule CreateShaderModule(Renderer* renderer, const std::vector<char>& code)
 {
     VkShaderModuleCreateInfo createInfo{};
@@ -1268,7 +1402,7 @@ void CreatePushConstant(Renderer* renderer)
     renderer->data.vkPushConstantRanges.push_back(pushConstantRange);
 }
 
-void  CreateGraphicsPipeline(Renderer* renderer, VkPipeline* pipeline, const std::string& vertShaderFilePath, const std::string& fragShaderFilePath, std::vector<VkPushConstantRange> pushConstants, VkDescriptorSetLayout* descriptorSetLayout, VkPipelineLayout* pipelineLayout)
+void  CreateGraphicsPipeline(Renderer* renderer, VkPipeline* pipeline, const std::string& vertShaderFilePath, const std::string& fragShaderFilePath, std::vector<VkPushConstantRange> pushConstants, VkDescriptorSetLayout* descriptorSetLayout, VkPipelineLayout* pipelineLayout, VertexFormat vertexFormat = VertexFormat_Float)
 {
     auto vertShaderCode = ReadFile(vertShaderFilePath);
     auto fragShaderCode = ReadFile(fragShaderFilePath);
@@ -1282,6 +1416,21 @@ void  CreateGraphicsPipeline(Renderer* renderer, VkPipeline* pipeline, const std
     vertShaderStageInfo.module = vertShaderModule;
     vertShaderStageInfo.pName = "main";
 
+    // Constant 0 of the vertex shaders, COMPACT_NORMALS: the compact variants
+    // decode octahedral normals in the shader.
+    VkBool32 compactNormals = vertexFormat == VertexFormat_Compact ? VK_TRUE : VK_FALSE;
+    VkSpecializationMapEntry specializationEntry{};
+    specializationEntry.constantID = 0;
+    specializationEntry.offset = 0;
+    specializationEntry.size = sizeof(VkBool32);
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = 1;
+    specializationInfo.pMapEntries = &specializationEntry;
+    specializationInfo.dataSize = sizeof(VkBool32);
+    specializationInfo.pData = &compactNormals;
+    vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
     VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
     fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -1293,12 +1442,17 @@ void  CreateGraphicsPipeline(Renderer* renderer, VkPipeline* pipeline, const std
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    auto bindingDescriptions = Vertex::getBindingDescriptions_instanced();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions_instanced();
+    // Only per-vertex data comes through vertex input; instances are read from set 1.
+    auto bindingDescription = Vertex::getBindingDescription();
+    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    if (vertexFormat == VertexFormat_Compact) {
+        bindingDescription = VertexCompact::getBindingDescription();
+        attributeDescriptions = VertexCompact::getAttributeDescriptions();
+    }
 
-    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -1365,13 +1519,16 @@ void  CreateGraphicsPipeline(Renderer* renderer, VkPipeline* pipeline, const std
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = descriptorSetLayout;
+    VkDescriptorSetLayout setLayouts[] = { *descriptorSetLayout, renderer->data.vkInstanceDescriptorSetLayout };
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
 
     pipelineLayoutInfo.pushConstantRangeCount = 0;
     pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
-    if (vkCreatePipelineLayout(renderer->data.vkDevice, &pipelineLayoutInfo, nullptr, pipelineLayout) != VK_SUCCESS)
+    // Vertex format variants of a pipeline share the layout made by the first one.
+    if (*pipelineLayout == VK_NULL_HANDLE &&
+        vkCreatePipelineLayout(renderer->data.vkDevice, &pipelineLayoutInfo, nullptr, pipelineLayout) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create pipeline layout!");
     }
@@ -1402,6 +1559,64 @@ void  CreateGraphicsPipeline(Renderer* renderer, VkPipeline* pipeline, const std
     vkDestroyShaderModule(renderer->data.vkDevice, vertShaderModule, nullptr);
 }
 
+// Optional: a missing shader or a failed build returns false and leaves the
+// batches culling on the CPU instead of aborting init.
+bool CreateCullPipeline(Renderer* renderer, const std::string& compShaderFilePath)
+{
+    VkShaderModule compShaderModule;
+    try
+    {
+        auto compShaderCode = ReadFile(compShaderFilePath);
+        compShaderModule = CreateShaderModule(renderer, compShaderCode);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "cull shader unavailable (" << e.what() << "), culling on the CPU" << std::endl;
+        return false;
+    }
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(CullPushConstant);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &renderer->data.vkInstanceDescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(renderer->data.vkDevice, &pipelineLayoutInfo, nullptr, &renderer->data.vkCullPipelineLayout) != VK_SUCCESS)
+    {
+        std::cout << "failed to create cull pipeline layout, culling on the CPU" << std::endl;
+        renderer->data.vkCullPipelineLayout = VK_NULL_HANDLE;
+        vkDestroyShaderModule(renderer->data.vkDevice, compShaderModule, nullptr);
+        return false;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = compShaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = renderer->data.vkCullPipelineLayout;
+
+    VkResult result = vkCreateComputePipelines(renderer->data.vkDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &renderer->data.vkCullPipeline);
+    vkDestroyShaderModule(renderer->data.vkDevice, compShaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+    {
+        std::cout << "failed to create cull pipeline, culling on the CPU" << std::endl;
+        vkDestroyPipelineLayout(renderer->data.vkDevice, renderer->data.vkCullPipelineLayout, nullptr);
+        renderer->data.vkCullPipelineLayout = VK_NULL_HANDLE;
+        renderer->data.vkCullPipeline = VK_NULL_HANDLE;
+        return false;
+    }
+    return true;
+}
+
 std::string GetShaderPath(const std::string& filename) {
 #ifdef WINDOWS
     return "../src/render/shaders/compiled/" + filename;
@@ -1420,7 +1635,7 @@ void CreateUniformBuffer(Renderer* renderer, std::vector<VkBuffer>& uniformBuffe
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i], uniformBuffersMemory[i]);
+        CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i], uniformBuffersMemory[i], MemoryTag_Render);
         vkMapMemory(renderer->data.vkDevice, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
     }
 }
@@ -1429,7 +1644,7 @@ void CreateUniformBuffer(Renderer* renderer, std::vector<VkBuffer>& uniformBuffe
 void CreateUniformBuffer(Zayn* zaynMem, VkBuffer* uniformBuffer, VkDeviceMemory* uniformBufferMemory, void** uniformBufferMapped, size_t bufferSize)
 {
     Renderer* renderer = &zaynMem->renderer;
-    CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, *uniformBuffer, *uniformBufferMemory);
+    CreateBuffer(renderer, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, *uniformBuffer, *uniformBufferMemory, MemoryTag_Material);
     vkMapMemory(renderer->data.vkDevice, *uniformBufferMemory, 0, bufferSize, 0, uniformBufferMapped);
 }
 
@@ -1513,13 +1728,22 @@ void InitRender_Vulkan(Renderer* renderer, WindowManager* window)
     CreateDescriptorPool(renderer, &renderer->data.vkDescriptorPool, true);
 
     CreatePushConstant<ModelPushConstant>(renderer);
+    InitInstanceDescriptors(renderer);
+    InitGeometryPool(renderer);
 
     CreateGraphicsPipeline(renderer, &renderer->data.vkGraphicsPipeline, GetShaderPath("vkShader_3d_vert.spv"), GetShaderPath("vkShader_3d_frag.spv"), renderer->data.vkPushConstantRanges, &renderer->data.vkDescriptorSetLayout, &renderer->data.vkPipelineLayout);
+    CreateGraphicsPipeline(renderer, &renderer->data.vkGraphicsPipelineCompact, GetShaderPath("vkShader_3d_vert.spv"), GetShaderPath("vkShader_3d_frag.spv"), renderer->data.vkPushConstantRanges, &renderer->data.vkDescriptorSetLayout, &renderer->data.vkPipelineLayout, VertexFormat_Compact);
 
     // Create lighting pipeline following LearnOpenGL Colors tutorial
     CreateDescriptorSetLayout(renderer, &renderer->data.vkLightingDescriptorSetLayout, true, true);
     CreateDescriptorPool(renderer, &renderer->data.vkLightingDescriptorPool, true);
     CreateGraphicsPipeline(renderer, &renderer->data.vkLightingGraphicsPipeline, GetShaderPath("vkShader_lighting_basic_vert.spv"), GetShaderPath("vkShader_lighting_basic_frag.spv"), renderer->data.vkPushConstantRanges, &renderer->data.vkLightingDescriptorSetLayout, &renderer->data.vkLightingPipelineLayout);
+    CreateGraphicsPipeline(renderer, &renderer->data.vkLightingGraphicsPipelineCompact, GetShaderPath("vkShader_lighting_basic_vert.spv"), GetShaderPath("vkShader_lighting_basic_frag.spv"), renderer->data.vkPushConstantRanges, &renderer->data.vkLightingDescriptorSetLayout, &renderer->data.vkLightingPipelineLayout, VertexFormat_Compact);
+
+    // Without it batches keep culling on the CPU
+    if (renderer->data.vkGpuCulling) {
+        renderer->data.vkGpuCulling = CreateCullPipeline(renderer, GetShaderPath("vkShader_cull_comp.spv"));
+    }
 
     CreateUniformBuffer(renderer, renderer->data.vkUniformBuffers, renderer->data.vkUniformBuffersMemory, renderer->data.vkUniformBuffersMapped);
     
@@ -89,6 +89,30 @@ else
 fi
 
 
+echo "Compiling Compute Shaders..."
+# Loop through all .comp files
+shopt -s nullglob
+compute_files=("$INPUT_DIR"/*.comp)
+shopt -u nullglob
+
+if [ ${#compute_files[@]} -eq 0 ]; then
+    echo "No .comp files found in $INPUT_DIR"
+else
+    for f in "${compute_files[@]}"; do
+      # Extract filename without .comp extension
+      base_name=$(basename "$f" .comp)
+      output_file="$OUTPUT_DIR/${base_name}_comp.spv"
+      echo "  Compiling $f -> $output_file"
+      # Run the compiler
+      "$GLSLC_PATH" "$f" -o "$output_file"
+      # Check for compilation errors
+      if [ $? -ne 0 ]; then
+          echo "  Error compiling $f"
+      fi
+    done
+fi
+
+
 echo "Shader compilation complete."
 
 # Optional pause - uncomment if needed
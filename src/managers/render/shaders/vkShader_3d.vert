@@ -16,24 +16,71 @@ layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inNormal;
 
-// Instance attributes (from instance buffer)
-layout(location = 4) in vec4 instanceModelMatrix0;
-layout(location = 5) in vec4 instanceModelMatrix1;
-layout(location = 6) in vec4 instanceModelMatrix2;
-layout(location = 7) in vec4 instanceModelMatrix3;
+// Per-instance transforms (InstanceTransform in render_vulkan.h): the top three
+// rows of the model matrix, indexed through visibleInstances below. Every
+// batch shares these buffers.
+struct InstanceTransform {
+    vec4 rows[3];
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer InstanceBuffer {
+    InstanceTransform instances[];
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer StaticInstanceBuffer {
+    InstanceTransform staticInstances[];
+};
+
+// Indices of the instances that survived frustum culling; each draw's
+// firstInstance selects its batch's slice. STATIC_INSTANCE_BIT marks
+// indices into staticInstances.
+layout(std430, set = 1, binding = 2) readonly buffer VisibleInstances {
+    uint visibleInstances[];
+};
+
+const uint STATIC_INSTANCE_BIT = 0x80000000u;
+
+// Set by the pipelines built for VertexCompact, whose normals arrive
+// octahedral-encoded as (x, y, 0).
+layout(constant_id = 0) const bool COMPACT_NORMALS = false;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragNormal;    // world space, assuming uniform scale
+
+// Inverse of OctahedralEncode in mesh_factory.cpp
+vec3 OctahedralDecode(vec2 e) {
+    vec3 n = vec3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.x = (1.0 - abs(e.y)) * (e.x >= 0.0 ? 1.0 : -1.0);
+        n.y = (1.0 - abs(e.x)) * (e.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
 
 void main() {
-    mat4 instanceModelMatrix = mat4(
-        instanceModelMatrix0,
-        instanceModelMatrix1,
-        instanceModelMatrix2,
-        instanceModelMatrix3
-    );
-    
-    gl_Position = ubo.proj * ubo.view * instanceModelMatrix * vec4(inPosition, 1.0);
+    uint index = visibleInstances[gl_InstanceIndex];
+    InstanceTransform instance;
+    if ((index & STATIC_INSTANCE_BIT) != 0u) {
+        instance = staticInstances[index & ~STATIC_INSTANCE_BIT];
+    } else {
+        instance = instances[index];
+    }
+    vec4 localPosition = vec4(inPosition, 1.0);
+    vec4 worldPosition = vec4(dot(instance.rows[0], localPosition),
+                              dot(instance.rows[1], localPosition),
+                              dot(instance.rows[2], localPosition),
+                              1.0);
+
+    vec3 normal = inNormal;
+    if (COMPACT_NORMALS) {
+        normal = OctahedralDecode(inNormal.xy);
+    }
+
+    gl_Position = ubo.proj * ubo.view * worldPosition;
     fragColor = inColor;
     fragTexCoord = inTexCoord;
+    fragNormal = normalize(vec3(dot(instance.rows[0].xyz, normal),
+                                dot(instance.rows[1].xyz, normal),
+                                dot(instance.rows[2].xyz, normal)));
 }
\ No newline at end of file
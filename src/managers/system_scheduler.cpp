@@ -0,0 +1,261 @@
+inline bool SystemsConflict(SystemAccess* a, SystemAccess* b) {
+    EntityTypeMask typeConflict = (a->writeTypes & (b->readTypes | b->writeTypes)) |
+                                  (b->writeTypes & a->readTypes);
+    uint64 componentConflict = (a->writeComponents & (b->readComponents | b->writeComponents)) |
+                               (b->writeComponents & a->readComponents);
+    uint32 resourceConflict = (a->writeResources & (b->readResources | b->writeResources)) |
+                              (b->writeResources & a->readResources);
+
+    return typeConflict || componentConflict || resourceConflict;
+}
+
+void RunSystemJob(SystemScheduler* scheduler, SystemJob* job) {
+    SystemDesc* desc = &job->system->desc;
+    desc->update(scheduler->zaynMem, job->buffer, job->first, job->count, desc->userData);
+}
+
+// Pulls jobs until the current phase is drained. Runs on workers and on the main thread.
+void RunSystemJobs(SystemScheduler* scheduler) {
+    for (;;) {
+        uint32 index = scheduler->nextJob.fetch_add(1);
+        if (index >= scheduler->jobCount) {
+            break;
+        }
+
+        RunSystemJob(scheduler, &scheduler->jobs[index]);
+
+        scheduler->jobsRemaining.fetch_sub(1);
+    }
+}
+
+void SystemWorkerMain(SystemScheduler* scheduler) {
+    // Register up front so systems can grab their thread arena without a first-use race.
+    GetThreadFrameArena(&scheduler->zaynMem->threadMemory);
+
+    uint64 seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(scheduler->mutex);
+            scheduler->workAvailable.wait(lock, [&] {
+                return scheduler->shuttingDown || scheduler->workGeneration != seenGeneration;
+            });
+
+            if (scheduler->shuttingDown) {
+                return;
+            }
+            seenGeneration = scheduler->workGeneration;
+            scheduler->activeWorkers++;
+        }
+
+        RunSystemJobs(scheduler);
+
+        {
+            std::lock_guard<std::mutex> lock(scheduler->mutex);
+            scheduler->activeWorkers--;
+        }
+        scheduler->workDone.notify_all();
+    }
+}
+
+void InitSystemScheduler(SystemScheduler* scheduler, Zayn* zaynMem) {
+    scheduler->systemCount = 0;
+    scheduler->phaseCount = 0;
+    scheduler->scheduleDirty = true;
+    scheduler->zaynMem = zaynMem;
+    scheduler->workGeneration = 0;
+    scheduler->activeWorkers = 0;
+    scheduler->shuttingDown = false;
+    scheduler->jobs = NULL;
+    scheduler->jobCount = 0;
+    scheduler->nextJob.store(0);
+    scheduler->jobsRemaining.store(0);
+
+    // The main thread already owns thread arena 0 and helps with every phase.
+    uint32 hardwareThreads = std::thread::hardware_concurrency();
+    uint32 workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    uint32 freeArenas = MAX_WORKER_THREADS - zaynMem->threadMemory.registeredThreadCount.load();
+    if (workerCount > freeArenas) {
+        workerCount = freeArenas;
+    }
+
+    scheduler->workerCount = workerCount;
+    for (uint32 i = 0; i < workerCount; i++) {
+        scheduler->workers[i] = std::thread(SystemWorkerMain, scheduler);
+    }
+}
+
+void ShutdownSystemScheduler(SystemScheduler* scheduler) {
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        scheduler->shuttingDown = true;
+    }
+    scheduler->workAvailable.notify_all();
+
+    for (uint32 i = 0; i < scheduler->workerCount; i++) {
+        scheduler->workers[i].join();
+    }
+    scheduler->workerCount = 0;
+}
+
+void RegisterSystem(SystemScheduler* scheduler, SystemDesc* desc) {
+    assert(scheduler->systemCount < MAX_SYSTEMS && "Too many systems registered");
+    assert(desc->update);
+
+    System* system = &scheduler->systems[scheduler->systemCount++];
+    system->desc = *desc;
+    system->phase = 0;
+
+    scheduler->scheduleDirty = true;
+}
+
+// Each system goes one phase after the latest earlier system it conflicts with,
+// so registration order decides which of two conflicting systems runs first.
+void BuildSystemSchedule(SystemScheduler* scheduler) {
+    scheduler->phaseCount = 0;
+
+    for (uint32 i = 0; i < scheduler->systemCount; i++) {
+        System* system = &scheduler->systems[i];
+        system->phase = 0;
+
+        for (uint32 j = 0; j < i; j++) {
+            System* earlier = &scheduler->systems[j];
+            if (earlier->phase + 1 > system->phase && SystemsConflict(&earlier->desc.access, &system->desc.access)) {
+                system->phase = earlier->phase + 1;
+            }
+        }
+
+        if (system->phase + 1 > scheduler->phaseCount) {
+            scheduler->phaseCount = system->phase + 1;
+        }
+    }
+
+    uint32 orderCount = 0;
+    for (uint32 phase = 0; phase < scheduler->phaseCount; phase++) {
+        scheduler->phaseStart[phase] = orderCount;
+        for (uint32 i = 0; i < scheduler->systemCount; i++) {
+            if (scheduler->systems[i].phase == phase) {
+                scheduler->order[orderCount++] = i;
+            }
+        }
+    }
+    scheduler->phaseStart[scheduler->phaseCount] = orderCount;
+
+    scheduler->scheduleDirty = false;
+}
+
+// Runs a main-thread system over every type it iterates, one whole buffer at a time.
+void RunSystemOnMainThread(SystemScheduler* scheduler, System* system) {
+    SystemDesc* desc = &system->desc;
+    EntityFactory* entityFactory = &scheduler->zaynMem->entityFactory;
+
+    if (!desc->iterateTypes) {
+        desc->update(scheduler->zaynMem, NULL, 0, 0, desc->userData);
+        return;
+    }
+
+    for (int32 type = 0; type < EntityType_Count; type++) {
+        EntityTypeBuffer* buffer = &entityFactory->buffers[type];
+        if (!(desc->iterateTypes & ENTITY_TYPE_BIT(type)) || buffer->count == 0) continue;
+
+        desc->update(scheduler->zaynMem, buffer, 0, buffer->count, desc->userData);
+    }
+}
+
+void RunSystemPhase(SystemScheduler* scheduler, uint32 phase) {
+    Zayn* zaynMem = scheduler->zaynMem;
+    EntityFactory* entityFactory = &zaynMem->entityFactory;
+
+    uint32 first = scheduler->phaseStart[phase];
+    uint32 end = scheduler->phaseStart[phase + 1];
+
+    // Count the jobs first so they fit in a single frameMemory block.
+    uint32 jobCount = 0;
+    for (uint32 i = first; i < end; i++) {
+        SystemDesc* desc = &scheduler->systems[scheduler->order[i]].desc;
+        if (desc->flags & SystemFlag_MainThread) continue;
+
+        if (!desc->iterateTypes) {
+            jobCount++;
+            continue;
+        }
+        for (int32 type = 0; type < EntityType_Count; type++) {
+            if (!(desc->iterateTypes & ENTITY_TYPE_BIT(type))) continue;
+            int32 count = entityFactory->buffers[type].count;
+            jobCount += (count + SYSTEM_JOB_CHUNK_SIZE - 1) / SYSTEM_JOB_CHUNK_SIZE;
+        }
+    }
+
+    SystemJob* jobs = PushArray(&zaynMem->frameMemory, SystemJob, jobCount > 0 ? jobCount : 1);
+    uint32 jobIndex = 0;
+    for (uint32 i = first; i < end; i++) {
+        System* system = &scheduler->systems[scheduler->order[i]];
+        if (system->desc.flags & SystemFlag_MainThread) continue;
+
+        if (!system->desc.iterateTypes) {
+            jobs[jobIndex++] = { system, NULL, 0, 0 };
+            continue;
+        }
+        for (int32 type = 0; type < EntityType_Count; type++) {
+            if (!(system->desc.iterateTypes & ENTITY_TYPE_BIT(type))) continue;
+
+            EntityTypeBuffer* buffer = &entityFactory->buffers[type];
+            for (int32 slot = 0; slot < buffer->count; slot += SYSTEM_JOB_CHUNK_SIZE) {
+                int32 count = buffer->count - slot;
+                if (count > SYSTEM_JOB_CHUNK_SIZE) {
+                    count = SYSTEM_JOB_CHUNK_SIZE;
+                }
+                jobs[jobIndex++] = { system, buffer, slot, count };
+            }
+        }
+    }
+    assert(jobIndex == jobCount);
+
+    if (jobCount > 0) {
+        {
+            std::unique_lock<std::mutex> lock(scheduler->mutex);
+            scheduler->workDone.wait(lock, [&] { return scheduler->activeWorkers == 0; });
+
+            scheduler->jobs = jobs;
+            scheduler->jobCount = jobCount;
+            scheduler->jobsRemaining.store(jobCount);
+            scheduler->nextJob.store(0);
+            if (jobCount > 1) {
+                scheduler->workGeneration++;
+            }
+        }
+        if (jobCount > 1) {
+            scheduler->workAvailable.notify_all();
+        }
+    }
+
+    // Main-thread systems overlap with the workers; the phase's access sets
+    // guarantee they touch nothing the parallel jobs write.
+    for (uint32 i = first; i < end; i++) {
+        System* system = &scheduler->systems[scheduler->order[i]];
+        if (system->desc.flags & SystemFlag_MainThread) {
+            RunSystemOnMainThread(scheduler, system);
+        }
+    }
+
+    if (jobCount > 0) {
+        RunSystemJobs(scheduler);
+
+        std::unique_lock<std::mutex> lock(scheduler->mutex);
+        scheduler->workDone.wait(lock, [&] {
+            return scheduler->jobsRemaining.load() == 0 && scheduler->activeWorkers == 0;
+        });
+
+        scheduler->jobs = NULL;
+        scheduler->jobCount = 0;
+    }
+}
+
+void RunSystems(SystemScheduler* scheduler) {
+    if (scheduler->scheduleDirty) {
+        BuildSystemSchedule(scheduler);
+    }
+
+    for (uint32 phase = 0; phase < scheduler->phaseCount; phase++) {
+        RunSystemPhase(scheduler, phase);
+    }
+}
@@ -0,0 +1,97 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define MAX_SYSTEMS 32
+
+// Dense ranges are cut into jobs of this many entities so one big type buffer
+// can be spread across the workers.
+#define SYSTEM_JOB_CHUNK_SIZE 256
+
+typedef uint64 EntityTypeMask;
+
+#define ENTITY_TYPE_BIT(type) (1ull << (type))
+#define ENTITY_TYPE_MASK_ALL ((1ull << EntityType_Count) - 1)
+#define COMPONENT_TYPE_BIT(T) (1ull << ComponentTypeId<T>())
+
+// Shared state that is neither an entity type nor a component.
+enum SystemResource {
+    SystemResource_RenderBatches = 1 << 0,
+    SystemResource_LightingData  = 1 << 1,
+    SystemResource_LevelData     = 1 << 2,
+};
+
+enum SystemFlags {
+    SystemFlag_None       = 0,
+    SystemFlag_MainThread = 1 << 0,   // touches Vulkan or other main-thread-only state
+};
+
+// What a system reads and writes. Two systems conflict when either one writes
+// something the other touches; conflicting systems run in registration order,
+// everything else in the same phase runs in parallel.
+struct SystemAccess {
+    EntityTypeMask readTypes;
+    EntityTypeMask writeTypes;
+    uint64 readComponents;
+    uint64 writeComponents;
+    uint32 readResources;
+    uint32 writeResources;
+};
+
+// Called with a dense [first, first + count) slice of one type buffer, or once
+// with buffer == NULL for systems that iterate no entity types. A system may
+// only write the slots it was handed.
+typedef void SystemUpdateFunc(Zayn* zaynMem, EntityTypeBuffer* buffer, int32 first, int32 count, void* userData);
+
+struct SystemDesc {
+    const char* name;
+    SystemUpdateFunc* update;
+    void* userData;
+
+    EntityTypeMask iterateTypes;
+    SystemAccess access;
+    uint32 flags;
+};
+
+struct System {
+    SystemDesc desc;
+    uint32 phase;
+};
+
+struct SystemJob {
+    System* system;
+    EntityTypeBuffer* buffer;
+    int32 first;
+    int32 count;
+};
+
+struct SystemScheduler {
+    System systems[MAX_SYSTEMS];
+    uint32 systemCount;
+
+    // Systems sorted by phase; phase p is order[phaseStart[p] .. phaseStart[p + 1]).
+    uint32 order[MAX_SYSTEMS];
+    uint32 phaseStart[MAX_SYSTEMS + 1];
+    uint32 phaseCount;
+    bool scheduleDirty;
+
+    Zayn* zaynMem;
+
+    // Worker pool. Jobs for the current phase live in frameMemory; the job
+    // fields are only republished while activeWorkers is zero, so a worker
+    // that wakes late can never claim an index against the wrong job list.
+    std::thread workers[MAX_WORKER_THREADS - 1];
+    uint32 workerCount;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    uint64 workGeneration;
+    uint32 activeWorkers;
+    bool shuttingDown;
+
+    SystemJob* jobs;
+    uint32 jobCount;
+    std::atomic<uint32> nextJob;
+    std::atomic<uint32> jobsRemaining;
+};
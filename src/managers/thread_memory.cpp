@@ -0,0 +1,39 @@
+// Index into ThreadMemory::threadArenas for the calling thread, -1 until registered.
+thread_local int32 tlsThreadArenaIndex = -1;
+
+void InitThreadMemory(ThreadMemory* threadMemory, MemoryArena* permanentMemory, uint64 perThreadReserve, uint64 sharedFrameSize) {
+    for (uint32 i = 0; i < MAX_WORKER_THREADS; i++) {
+        ReserveMemoryArena(&threadMemory->threadArenas[i].frameArena, perThreadReserve);
+    }
+    threadMemory->registeredThreadCount.store(0);
+
+    void* sharedBlock = PushSizeAligned(permanentMemory, sharedFrameSize, 64);
+    InitAtomicMemoryArena(&threadMemory->sharedFrameMemory, sharedBlock, sharedFrameSize);
+}
+
+// Returns the calling thread's scratch arena, registering the thread on first use.
+MemoryArena* GetThreadFrameArena(ThreadMemory* threadMemory) {
+    if (tlsThreadArenaIndex < 0) {
+        uint32 index = threadMemory->registeredThreadCount.fetch_add(1);
+        assert(index < MAX_WORKER_THREADS && "Too many threads registered with ThreadMemory");
+        tlsThreadArenaIndex = (int32)index;
+    }
+
+    return &threadMemory->threadArenas[tlsThreadArenaIndex].frameArena;
+}
+
+// Called once per frame from the main thread while the workers are idle.
+void ResetThreadMemory(ThreadMemory* threadMemory) {
+    uint32 threadCount = threadMemory->registeredThreadCount.load();
+    for (uint32 i = 0; i < threadCount && i < MAX_WORKER_THREADS; i++) {
+        ClearMemoryArena(&threadMemory->threadArenas[i].frameArena);
+    }
+
+    ClearAtomicMemoryArena(&threadMemory->sharedFrameMemory);
+}
+
+void ShutdownThreadMemory(ThreadMemory* threadMemory) {
+    for (uint32 i = 0; i < MAX_WORKER_THREADS; i++) {
+        ReleaseMemoryArena(&threadMemory->threadArenas[i].frameArena);
+    }
+}
@@ -0,0 +1,15 @@
+#define MAX_WORKER_THREADS 16
+
+// Each thread's arena sits on its own cache line(s) so bumping one
+// thread's size never invalidates another thread's line.
+struct alignas(64) ThreadArena {
+    MemoryArena frameArena;
+};
+
+struct ThreadMemory {
+    ThreadArena threadArenas[MAX_WORKER_THREADS];
+    std::atomic<uint32> registeredThreadCount;
+
+    // Frame data written by several workers at once (e.g. visible instance lists).
+    AtomicMemoryArena sharedFrameMemory;
+};
@@ -0,0 +1,75 @@
+
+// Frustum planes stored one component per array so four spheres can be
+// tested against a plane at once. A point p is inside plane i when
+// nx[i] * p.x + ny[i] * p.y + nz[i] * p.z + d[i] >= 0.
+struct FrustumPlanes {
+    real32 nx[6];
+    real32 ny[6];
+    real32 nz[6];
+    real32 d[6];
+};
+
+// Gribb-Hartmann extraction from a column-major clip matrix with Vulkan's
+// [0, 1] depth range. The planes are normalized so sphere radii compare directly.
+inline FrustumPlanes ExtractFrustumPlanes(mat4 viewProjection) {
+    vec4 rows[4];
+    for (int32 row = 0; row < 4; row++) {
+        rows[row] = V4(viewProjection.data[row], viewProjection.data[4 + row],
+                       viewProjection.data[8 + row], viewProjection.data[12 + row]);
+    }
+
+    vec4 planes[6] = {
+        rows[3] + rows[0],    // left
+        rows[3] - rows[0],    // right
+        rows[3] + rows[1],    // bottom
+        rows[3] - rows[1],    // top
+        rows[2],              // near
+        rows[3] - rows[2],    // far
+    };
+
+    FrustumPlanes result;
+    for (int32 i = 0; i < 6; i++) {
+        real32 invLength = 1.0f / Length(planes[i].xyz);
+        result.nx[i] = planes[i].x * invLength;
+        result.ny[i] = planes[i].y * invLength;
+        result.nz[i] = planes[i].z * invLength;
+        result.d[i] = planes[i].w * invLength;
+    }
+    return result;
+}
+
+// Writes indexBase + i for every sphere i in [0, count) that touches the
+// frustum and returns how many were written. Spheres of radius zero or less
+// are never written. The arrays are read in groups
+// of four, so they must be readable up to count rounded up to a multiple of 4.
+inline uint32 CullSpheres(FrustumPlanes* frustum, const real32* centerX, const real32* centerY, const real32* centerZ,
+                          const real32* radius, uint32 count, uint32 indexBase, uint32* visible) {
+    uint32 visibleCount = 0;
+
+    for (uint32 first = 0; first < count; first += 4) {
+        f32x4 x = LoadF32x4(centerX + first);
+        f32x4 y = LoadF32x4(centerY + first);
+        f32x4 z = LoadF32x4(centerZ + first);
+        f32x4 r = LoadF32x4(radius + first);
+        f32x4 negRadius = MulF32x4(r, F32x4(-1.0f));
+
+        uint32 mask = ~GreaterEqualMask(F32x4(0.0f), r) & 0xF;
+        for (int32 i = 0; i < 6 && mask; i++) {
+            f32x4 distance = AddF32x4(AddF32x4(MulF32x4(x, F32x4(frustum->nx[i])), MulF32x4(y, F32x4(frustum->ny[i]))),
+                                      AddF32x4(MulF32x4(z, F32x4(frustum->nz[i])), F32x4(frustum->d[i])));
+            mask &= GreaterEqualMask(distance, negRadius);
+        }
+
+        if (count - first < 4) {
+            mask &= (1u << (count - first)) - 1;
+        }
+
+        for (uint32 lane = 0; lane < 4; lane++) {
+            if (mask & (1u << lane)) {
+                visible[visibleCount++] = indexBase + first + lane;
+            }
+        }
+    }
+
+    return visibleCount;
+}
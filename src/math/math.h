@@ -17,7 +17,8 @@
 #include "quaternion.h"
 #include "matrix.h"
 #include "rand.h"
-// #include "math/geometry.h"
+#include "simd.h"
+#include "geometry.h"
 
 // #include "math/color.h"
 
@@ -0,0 +1,85 @@
+
+// Four-wide float vectors: SSE2 on x86, NEON on ARM64, plain arrays elsewhere.
+// Only what the batch culling needs; loads are unaligned.
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SIMD_NEON 1
+#endif
+
+#if SIMD_SSE2
+typedef __m128 f32x4;
+#elif SIMD_NEON
+typedef float32x4_t f32x4;
+#else
+struct f32x4 {
+    real32 lane[4];
+};
+#endif
+
+inline f32x4 F32x4(real32 value) {
+#if SIMD_SSE2
+    return _mm_set1_ps(value);
+#elif SIMD_NEON
+    return vdupq_n_f32(value);
+#else
+    f32x4 result;
+    for (int32 i = 0; i < 4; i++) result.lane[i] = value;
+    return result;
+#endif
+}
+
+inline f32x4 LoadF32x4(const real32* values) {
+#if SIMD_SSE2
+    return _mm_loadu_ps(values);
+#elif SIMD_NEON
+    return vld1q_f32(values);
+#else
+    f32x4 result;
+    for (int32 i = 0; i < 4; i++) result.lane[i] = values[i];
+    return result;
+#endif
+}
+
+inline f32x4 AddF32x4(f32x4 a, f32x4 b) {
+#if SIMD_SSE2
+    return _mm_add_ps(a, b);
+#elif SIMD_NEON
+    return vaddq_f32(a, b);
+#else
+    f32x4 result;
+    for (int32 i = 0; i < 4; i++) result.lane[i] = a.lane[i] + b.lane[i];
+    return result;
+#endif
+}
+
+inline f32x4 MulF32x4(f32x4 a, f32x4 b) {
+#if SIMD_SSE2
+    return _mm_mul_ps(a, b);
+#elif SIMD_NEON
+    return vmulq_f32(a, b);
+#else
+    f32x4 result;
+    for (int32 i = 0; i < 4; i++) result.lane[i] = a.lane[i] * b.lane[i];
+    return result;
+#endif
+}
+
+// Bit i of the result is set when lane i of a >= lane i of b.
+inline uint32 GreaterEqualMask(f32x4 a, f32x4 b) {
+#if SIMD_SSE2
+    return (uint32)_mm_movemask_ps(_mm_cmpge_ps(a, b));
+#elif SIMD_NEON
+    const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+    return vaddvq_u32(vandq_u32(vcgeq_f32(a, b), vld1q_u32(laneBits)));
+#else
+    uint32 result = 0;
+    for (int32 i = 0; i < 4; i++) {
+        if (a.lane[i] >= b.lane[i]) result |= 1u << i;
+    }
+    return result;
+#endif
+}
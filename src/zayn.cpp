@@ -19,12 +19,14 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_vulkan.h"
 #include "managers/memory.cpp"
+#include "managers/thread_memory.cpp"
 #include "managers/time.cpp"
 #include "managers/window.cpp"
 #include "managers/input.cpp"
 #include "managers/camera.cpp"
 
 
+#include "managers/system_scheduler.cpp"
 #include "managers/factory/entity_factory.cpp"
 #include "managers/render/render.cpp"
 #include "managers/factory/components_factory.cpp"
@@ -49,8 +51,11 @@ void InitZayn(Zayn* zaynMem) {
 
     // @todo: create init log
 
-    AllocateMemoryArena(&zaynMem->frameMemory, Megabytes(32));
-    AllocateMemoryArena(&zaynMem->permanentMemory, Megabytes(32));
+    ReserveMemoryArena(&zaynMem->frameMemory, Gigabytes(1));
+    ReserveMemoryArena(&zaynMem->permanentMemory, Gigabytes(8));
+    InitSizeClassAllocator(&zaynMem->generalMemory, &zaynMem->permanentMemory);
+    InitThreadMemory(&zaynMem->threadMemory, &zaynMem->permanentMemory, Megabytes(256), Megabytes(16));
+    GetThreadFrameArena(&zaynMem->threadMemory);    // main thread takes slot 0
 
     InitTime(&zaynMem->time);
     InitInputManager(&zaynMem->inputManager, &zaynMem->permanentMemory);
@@ -62,7 +67,9 @@ void InitZayn(Zayn* zaynMem) {
     InitTextureFactory(zaynMem);
     InitMaterialFactory(zaynMem);
     InitEntityFactory(&zaynMem->entityFactory, zaynMem);
-    InitComponentsFactory(&zaynMem->componentsFactory, &zaynMem->permanentMemory);
+    InitComponentsFactory(&zaynMem->componentsFactory, &zaynMem->generalMemory);
+    InitSystemScheduler(&zaynMem->systemScheduler, zaynMem);
+    RegisterTransformSystems(zaynMem);
     InitLevelManager(&zaynMem->levelManager);
     InitLevelEditor(&zaynMem->levelEditor);
 
@@ -75,6 +82,10 @@ void InitZayn(Zayn* zaynMem) {
 
 void UpdateZayn(Zayn* zaynMem) {
 
+    // Everything in frameMemory only lives for one frame.
+    ClearMemoryArena(&zaynMem->frameMemory);
+    ResetThreadMemory(&zaynMem->threadMemory);
+
     UpdateTime(zaynMem);
     UpdateInputManager(zaynMem);
 
@@ -83,6 +94,8 @@ void UpdateZayn(Zayn* zaynMem) {
     // Update level editor
     UpdateLevelEditor(zaynMem, &zaynMem->levelEditor);
 
+    RunSystems(&zaynMem->systemScheduler);
+
     UpdateRenderer(zaynMem, &zaynMem->renderer, &zaynMem->windowManager, &zaynMem->camera, &zaynMem->inputManager);
 
     // LOGIC
@@ -109,6 +122,11 @@ void UpdateZayn(Zayn* zaynMem) {
 void ShutdownZayn(Zayn* zaynMem) {
     std::cout<<"ShutdownEngine"<<std::endl;
     glfwTerminate();
+
+    ShutdownSystemScheduler(&zaynMem->systemScheduler);
+    ShutdownThreadMemory(&zaynMem->threadMemory);
+    ReleaseMemoryArena(&zaynMem->frameMemory);
+    ReleaseMemoryArena(&zaynMem->permanentMemory);
 }
 
 // void InitEngine(Engine* engine) {
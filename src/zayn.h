@@ -5,6 +5,7 @@
 
 
 #include "managers/memory.h"
+#include "managers/thread_memory.h"
 
 #include "managers/time.h"
 #include "dynamicArray.h"
@@ -15,6 +16,7 @@
 #include "managers/render/render.h"
 #include "managers/factory/entity_factory.h"
 #include "managers/factory/components_factory.h"
+#include "managers/system_scheduler.h"
 #include "managers/factory/mesh_factory.h"
 #include "managers/factory/texture_factory.h"
 #include "managers/factory/material_factory.h"
@@ -32,6 +34,8 @@ struct Zayn {
 
     MemoryArena frameMemory;
     MemoryArena permanentMemory;
+    SizeClassAllocator generalMemory;   // recyclable allocations (batches, instance arrays)
+    ThreadMemory threadMemory;          // per-thread frame scratch + shared lock-free frame arena
 
     ComponentsFactory componentsFactory;
     EntityFactory entityFactory;
@@ -39,6 +43,8 @@ struct Zayn {
     MaterialFactory materialFactory;
     TextureFactory textureFactory;
 
+    SystemScheduler systemScheduler;
+
 
     GameData gameData;
     LevelManager levelManager;